@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+#include "spade.arena.h"
+
+/**
+ * Rounds a size up to the arena alignment.
+ *
+ * @param size The size to round
+ * @return size rounded up to a multiple of ARENA_ALIGNMENT
+ */
+size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * Initializes an empty arena. No memory is allocated until the first arena_alloc.
+ *
+ * @param arena The arena to initialize
+ */
+void init_arena(Arena *arena) {
+    arena->head = NULL;
+}
+
+/**
+ * Chains a new block onto an arena.
+ *
+ * @param arena The arena to grow
+ * @param min_size The smallest payload the block must hold
+ * @return The new block, or NULL on allocation failure
+ */
+ArenaBlock *arena_new_block(Arena *arena, size_t min_size) {
+    size_t capacity = min_size > ARENA_BLOCK_SIZE ? min_size : ARENA_BLOCK_SIZE;
+    ArenaBlock *block = malloc(arena_align(sizeof(ArenaBlock)) + capacity);
+    if (!block) return NULL;
+
+    block->data = (char *)block + arena_align(sizeof(ArenaBlock));
+    block->used = 0;
+    block->capacity = capacity;
+    block->next = arena->head;
+    arena->head = block;
+    return block;
+}
+
+/**
+ * Allocates memory from an arena.
+ *
+ * The memory is uninitialized and stays valid until free_arena.
+ *
+ * @param arena The arena to allocate from
+ * @param size Number of bytes to allocate
+ * @return Pointer to the memory (aligned to ARENA_ALIGNMENT), or NULL on allocation failure
+ */
+void *arena_alloc(Arena *arena, size_t size) {
+    size = arena_align(size ? size : 1);
+    ArenaBlock *block = arena->head;
+    if (!block || block->capacity - block->used < size) {
+        block = arena_new_block(arena, size);
+        if (!block) return NULL;
+    }
+    void *memory = block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+/**
+ * Resizes an arena allocation, like realloc.
+ *
+ * If old was the most recent allocation and the block has room, it is
+ * extended in place; otherwise the contents are copied to a new allocation
+ * and the old space is simply abandoned until the arena is freed.
+ *
+ * @param arena The arena old was allocated from
+ * @param old The allocation to resize, or NULL to allocate fresh memory
+ * @param old_size The current size of old in bytes
+ * @param new_size The required size in bytes
+ * @return Pointer to the resized allocation, or NULL on allocation failure
+ */
+void *arena_grow(Arena *arena, void *old, size_t old_size, size_t new_size) {
+    if (new_size <= old_size) return old;
+
+    ArenaBlock *block = arena->head;
+    if (old && block && (char *)old + arena_align(old_size) == block->data + block->used) {
+        size_t extra = arena_align(new_size) - arena_align(old_size);
+        if (block->capacity - block->used >= extra) {
+            block->used += extra;
+            return old;
+        }
+    }
+
+    void *memory = arena_alloc(arena, new_size);
+    if (memory && old) memcpy(memory, old, old_size);
+    return memory;
+}
+
+/**
+ * Copies a string into an arena and NUL-terminates it.
+ *
+ * @param arena The arena to copy into
+ * @param string The bytes to copy (may contain NUL bytes)
+ * @param length Number of bytes to copy
+ * @return The copy, or NULL on allocation failure
+ */
+char *arena_strndup(Arena *arena, const char *string, size_t length) {
+    char *copy = arena_alloc(arena, length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+/**
+ * Frees every block of an arena, invalidating all memory allocated from it.
+ *
+ * @param arena The arena to free; it is left empty and can be reused
+ */
+void free_arena(Arena *arena) {
+    ArenaBlock *block = arena->head;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+}
@@ -0,0 +1,37 @@
+#ifndef SPADE_ARENA_H
+#define SPADE_ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)  // Default payload size of an arena block
+#define ARENA_ALIGNMENT 16            // Every allocation is aligned to this many bytes
+
+/**
+ * One chunk of arena memory. Blocks form a singly linked list, newest first.
+ */
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;  // Previously filled block
+    size_t used;              // Bytes handed out from data
+    size_t capacity;          // Size of data in bytes
+    char *data;               // Start of the block's payload (aligned)
+} ArenaBlock;
+
+/**
+ * Bump allocator for data that is freed all at once.
+ *
+ * Allocation is a pointer bump inside the current block; a new block is
+ * chained on when it runs out. Individual allocations are never freed.
+ * free_arena releases every block in one pass, so tearing down a whole
+ * tree of allocations costs one free per block instead of one per object.
+ */
+typedef struct {
+    ArenaBlock *head;  // Block currently being allocated from (NULL before the first allocation)
+} Arena;
+
+void init_arena(Arena *arena);
+void *arena_alloc(Arena *arena, size_t size);
+void *arena_grow(Arena *arena, void *old, size_t old_size, size_t new_size);
+char *arena_strndup(Arena *arena, const char *string, size_t length);
+void free_arena(Arena *arena);
+
+#endif
@@ -0,0 +1,351 @@
+#include <stdlib.h>
+#include <string.h>
+#include "spade.bytecode.h"
+
+/**
+ * Finishes reading an unsigned LEB128 operand whose first byte (at pc - 1)
+ * had its continuation bit set. Only for verified bytecode.
+ *
+ * @param pc Points just past the operand's first byte
+ * @param value Receives the operand
+ * @return Pointer just past the operand
+ */
+const unsigned char *read_uleb128_tail(const unsigned char *pc, int *value) {
+    unsigned int result = pc[-1] & 0x7f;
+    int shift = 7;
+    unsigned int byte;
+    do {
+        byte = *pc++;
+        result |= (byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    *value = (int)result;
+    return pc;
+}
+
+/**
+ * Finishes reading a signed LEB128 operand whose first byte (at pc - 1) had
+ * its continuation bit set. Only for verified bytecode.
+ *
+ * @param pc Points just past the operand's first byte
+ * @param value Receives the operand
+ * @return Pointer just past the operand
+ */
+const unsigned char *read_sleb128_tail(const unsigned char *pc, int *value) {
+    unsigned int result = pc[-1] & 0x7f;
+    int shift = 7;
+    unsigned int byte;
+    do {
+        byte = *pc++;
+        result |= (byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    if (shift < 32 && (byte & 0x40)) {
+        result |= ~0u << shift;
+    }
+    *value = (int)result;
+    return pc;
+}
+
+/**
+ * Returns how many operands an instruction carries in bytecode.
+ *
+ * Every operand layout starts with its int fields packed from the start of
+ * the operand union, so they can be read and written as operand.var_pair.
+ *
+ * @param opcode The instruction's opcode
+ * @return 0, 1 or 2
+ */
+int ir_operand_count(IROpcode opcode) {
+    switch (opcode) {
+        case IR_PUSH_CONST:
+        case IR_PUSH_VAR:
+        case IR_PUSH_STRING_LIT:
+        case IR_STORE_VAR:
+        case IR_JUMP:
+        case IR_JUMP_IF_FALSE:
+        case IR_JUMP_IF_TRUE:
+            return 1;
+        case IR_ADD_VAR_CONST:
+        case IR_INC_VAR:
+        case IR_EQ_VAR_VAR:
+        case IR_NE_VAR_VAR:
+        case IR_LT_VAR_VAR:
+        case IR_LE_VAR_VAR:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Tells whether an operand is a signed constant rather than a slot or index.
+ *
+ * @param opcode The instruction's opcode
+ * @param operand 0 for the first operand, 1 for the second
+ * @return 1 if the operand is signed, 0 otherwise
+ */
+int ir_operand_is_signed(IROpcode opcode, int operand) {
+    if (opcode == IR_PUSH_CONST) return 1;
+    return operand == 1 && (opcode == IR_ADD_VAR_CONST || opcode == IR_INC_VAR);
+}
+
+/**
+ * Writes one LEB128 operand.
+ *
+ * @param value The operand
+ * @param is_signed Whether to use the signed encoding
+ * @param out Where to write (at least 5 bytes)
+ * @return Number of bytes written
+ */
+int encode_leb128(int value, int is_signed, unsigned char *out) {
+    int length = 0;
+    if (!is_signed) {
+        unsigned int rest = (unsigned int)value;
+        while (rest >= 0x80) {
+            out[length++] = (unsigned char)(rest | 0x80);
+            rest >>= 7;
+        }
+        out[length++] = (unsigned char)rest;
+        return length;
+    }
+
+    long long rest = value;
+    for (;;) {
+        unsigned char byte = (unsigned char)(rest & 0x7f);
+        rest = (rest - byte) / 128;  // Exact, so this is an arithmetic shift by 7
+        int done = (rest == 0 && !(byte & 0x40)) || (rest == -1 && (byte & 0x40));
+        out[length++] = done ? byte : (unsigned char)(byte | 0x80);
+        if (done) return length;
+    }
+}
+
+/**
+ * Reads one LEB128 operand from untrusted bytes.
+ *
+ * @param bytes The bytecode
+ * @param size Size of the bytecode in bytes
+ * @param offset Offset of the operand; advanced past it on success
+ * @param is_signed Whether the operand uses the signed encoding
+ * @param value Receives the operand
+ * @return 1 on success, 0 if the operand is truncated, longer than 5 bytes or does not fit 32 bits
+ */
+int decode_leb128(const unsigned char *bytes, int size, int *offset, int is_signed, int *value) {
+    // Most operands are a single byte
+    if (*offset < size && bytes[*offset] < 0x80) {
+        unsigned int first = bytes[(*offset)++];
+        *value = is_signed ? (int)(first ^ 0x40) - 0x40 : (int)first;
+        return 1;
+    }
+
+    long long result = 0;
+    int shift = 0;
+    unsigned int byte;
+    do {
+        if (*offset >= size || shift >= 35) return 0;
+        byte = bytes[(*offset)++];
+        result |= (long long)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    if (is_signed && (byte & 0x40)) {
+        result -= 1LL << shift;
+    }
+    if (is_signed ? (result < -2147483647LL - 1 || result > 2147483647LL)
+                  : result > 0xFFFFFFFFLL) {
+        return 0;
+    }
+    // Unsigned operands carry the int's bits, so an unresolved slot (-1) survives for the verifier to report
+    *value = (int)(unsigned int)result;
+    return 1;
+}
+
+/**
+ * Encodes one instruction as bytecode.
+ *
+ * @param instr The instruction (its opcode must be a valid IROpcode)
+ * @param out Where to write (at least BYTECODE_MAX_INSTRUCTION bytes)
+ * @return Number of bytes written
+ */
+int encode_ir_instruction(const IRInstruction *instr, unsigned char *out) {
+    int length = 0;
+    out[length++] = (unsigned char)instr->opcode;
+    int operands = ir_operand_count(instr->opcode);
+    if (operands >= 1) {
+        length += encode_leb128(instr->operand.var_pair.left, ir_operand_is_signed(instr->opcode, 0), out + length);
+    }
+    if (operands >= 2) {
+        length += encode_leb128(instr->operand.var_pair.right, ir_operand_is_signed(instr->opcode, 1), out + length);
+    }
+    return length;
+}
+
+/**
+ * Decodes one instruction from possibly untrusted bytecode.
+ *
+ * @param bytes The bytecode
+ * @param size Size of the bytecode in bytes
+ * @param offset Offset of the instruction's opcode byte
+ * @param instr Receives the instruction (unused operand fields are zeroed)
+ * @return Offset of the next instruction, or -1 if the opcode is invalid or an operand is malformed
+ */
+int decode_ir_instruction(const unsigned char *bytes, int size, int offset, IRInstruction *instr) {
+    if (offset < 0 || offset >= size || bytes[offset] > IR_HALT) return -1;
+
+    memset(instr, 0, sizeof(*instr));
+    instr->opcode = (IROpcode)bytes[offset++];
+    int operands = ir_operand_count(instr->opcode);
+    if (operands >= 1 &&
+        !decode_leb128(bytes, size, &offset, ir_operand_is_signed(instr->opcode, 0), &instr->operand.var_pair.left)) {
+        return -1;
+    }
+    if (operands >= 2 &&
+        !decode_leb128(bytes, size, &offset, ir_operand_is_signed(instr->opcode, 1), &instr->operand.var_pair.right)) {
+        return -1;
+    }
+    return offset;
+}
+
+/**
+ * Lays out packed instructions, giving each one its byte offset.
+ *
+ * A jump's operand is its target's byte offset, whose encoded length depends
+ * on where the target ends up. Offsets start out as the smallest possible
+ * layout and are recomputed until they stop changing; operands only ever
+ * grow, so this settles after a pass or two.
+ *
+ * @param code The IR code to lay out (jump targets are instruction indices)
+ * @param offsets Receives count + 1 offsets; the last one is the total size
+ * @param has_jumps Whether the code contains jumps (without any, one pass is exact)
+ */
+void layout_ir_code(IRCode *code, int *offsets, int has_jumps) {
+    unsigned char scratch[BYTECODE_MAX_INSTRUCTION];
+    memset(offsets, 0, sizeof(int) * (code->count + 1));
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        int offset = 0;
+        for (int i = 0; i < code->count; i++) {
+            if (offsets[i] != offset) {
+                offsets[i] = offset;
+                changed = 1;
+            }
+            IRInstruction instr = code->instructions[i];
+            if (ir_is_jump(instr.opcode)) {
+                instr.operand.target = offsets[instr.operand.target];
+            }
+            offset += encode_ir_instruction(&instr, scratch);
+        }
+        if (offsets[code->count] != offset) {
+            offsets[code->count] = offset;
+            changed = 1;
+        }
+        if (!has_jumps) break;
+    }
+}
+
+/**
+ * Packs IR code's instructions into bytecode for the VM.
+ *
+ * Jump targets are converted from instruction indices to absolute byte
+ * offsets, so a taken branch is a single pointer assignment in the VM.
+ *
+ * Must run after the last change to the instructions (generation and
+ * optimization); any bytecode packed earlier is replaced. Code loaded from
+ * an image already has its bytecode and is never packed.
+ *
+ * @param code The IR code to pack
+ * @return 1 on success, 0 if an opcode or jump target is invalid or memory runs out
+ */
+int pack_ir_code(IRCode *code) {
+    int has_jumps = 0;
+    for (int i = 0; i < code->count; i++) {
+        IRInstruction *instr = &code->instructions[i];
+        if (instr->opcode < 0 || instr->opcode > IR_HALT) return 0;
+        if (ir_is_jump(instr->opcode)) {
+            if (instr->operand.target < 0 || instr->operand.target > code->count) return 0;
+            has_jumps = 1;
+        }
+    }
+
+    int *offsets = malloc(sizeof(int) * (code->count + 1));
+    if (!offsets) return 0;
+    layout_ir_code(code, offsets, has_jumps);
+
+    unsigned char *bytes = malloc(offsets[code->count] ? offsets[code->count] : 1);
+    if (!bytes) {
+        free(offsets);
+        return 0;
+    }
+
+    int size = 0;
+    for (int i = 0; i < code->count; i++) {
+        IRInstruction instr = code->instructions[i];
+        if (ir_is_jump(instr.opcode)) {
+            instr.operand.target = offsets[instr.operand.target];
+        }
+        size += encode_ir_instruction(&instr, bytes + size);
+    }
+    free(offsets);
+
+    free(code->bytecode);
+    code->bytecode = bytes;
+    code->bytecode_size = size;
+    code->verified_depth = -1;
+    return 1;
+}
+
+/**
+ * Rebuilds IR code's instruction array from its bytecode.
+ *
+ * Code loaded from an image only has bytecode; the register tier and the IR
+ * dump work on instructions and call this first. Jump targets are turned
+ * back from byte offsets into instruction indices.
+ *
+ * @param code The IR code to unpack (its instructions must not be allocated yet)
+ * @return 1 on success, 0 if the bytecode is malformed (including a jump into
+ *         the middle of an instruction) or memory runs out
+ */
+int unpack_ir_code(IRCode *code) {
+    IRInstruction instr;
+    int count = 0;
+    for (int offset = 0; offset < code->bytecode_size; count++) {
+        offset = decode_ir_instruction(code->bytecode, code->bytecode_size, offset, &instr);
+        if (offset < 0) return 0;
+    }
+
+    IRInstruction *instructions = malloc(sizeof(IRInstruction) * (count ? count : 1));
+    int *index_at = malloc(sizeof(int) * (code->bytecode_size + 1));
+    if (!instructions || !index_at) {
+        free(instructions);
+        free(index_at);
+        return 0;
+    }
+
+    // index_at maps the offset of every instruction's opcode byte to its index, and is -1 elsewhere
+    for (int offset = 0; offset <= code->bytecode_size; offset++) {
+        index_at[offset] = -1;
+    }
+    for (int i = 0, offset = 0; i < count; i++) {
+        index_at[offset] = i;
+        offset = decode_ir_instruction(code->bytecode, code->bytecode_size, offset, &instructions[i]);
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!ir_is_jump(instructions[i].opcode)) continue;
+        int target = instructions[i].operand.target;
+        if (target < 0 || target >= code->bytecode_size || index_at[target] < 0) {
+            free(instructions);
+            free(index_at);
+            return 0;
+        }
+        instructions[i].operand.target = index_at[target];
+    }
+    free(index_at);
+
+    code->instructions = instructions;
+    code->count = count;
+    code->capacity = count;
+    return 1;
+}
@@ -0,0 +1,62 @@
+#ifndef SPADE_BYTECODE_H
+#define SPADE_BYTECODE_H
+
+#include "spade.ir.h"
+
+/**
+ * Packed bytecode: the form of IR code the stack VM executes and images store.
+ *
+ * Every instruction is its IROpcode in one byte followed by only the
+ * operands it uses, each as LEB128:
+ *
+ *   PUSH_CONST          value (signed)
+ *   PUSH_VAR, STORE_VAR slot
+ *   PUSH_STRING_LIT     literal index
+ *   ADD_VAR_CONST,      slot, value (signed)
+ *   INC_VAR
+ *   *_VAR_VAR           left slot, right slot
+ *   JUMP, JUMP_IF_FALSE target (absolute byte offset of an opcode)
+ *   JUMP_IF_TRUE
+ *   everything else     no operands
+ *
+ * Slots, literal indices and small constants take one byte each, so most
+ * instructions are one to three bytes instead of sizeof(IRInstruction).
+ * Variable names and string literals stay in the IRCode's side tables.
+ *
+ * The encoding has no alignment or byte order, but operands are only
+ * bounds-checked by decode_ir_instruction; the VM's fast readers below trust
+ * code that verify_ir_code has accepted.
+ */
+
+#define BYTECODE_MAX_INSTRUCTION 11  // Opcode byte plus two 5-byte operands
+
+/**
+ * Reads an unsigned operand at pc into var and advances pc. One-byte values
+ * take the inline path; longer ones finish in read_uleb128_tail.
+ */
+#define BYTECODE_READ_UINT(pc, var) do { \
+        unsigned int byte_ = *(pc)++; \
+        (var) = (int)byte_; \
+        if (byte_ & 0x80) (pc) = read_uleb128_tail((pc), &(var)); \
+    } while (0)
+
+/**
+ * Reads a signed operand at pc into var and advances pc.
+ */
+#define BYTECODE_READ_INT(pc, var) do { \
+        unsigned int byte_ = *(pc)++; \
+        (var) = (int)(byte_ ^ 0x40) - 0x40; \
+        if (byte_ & 0x80) (pc) = read_sleb128_tail((pc), &(var)); \
+    } while (0)
+
+const unsigned char *read_uleb128_tail(const unsigned char *pc, int *value);
+const unsigned char *read_sleb128_tail(const unsigned char *pc, int *value);
+
+int ir_operand_count(IROpcode opcode);
+int encode_ir_instruction(const IRInstruction *instr, unsigned char *out);
+int decode_ir_instruction(const unsigned char *bytes, int size, int offset, IRInstruction *instr);
+void layout_ir_code(IRCode *code, int *offsets, int has_jumps);
+int pack_ir_code(IRCode *code);
+int unpack_ir_code(IRCode *code);
+
+#endif
@@ -3,27 +3,478 @@
 #include <stdlib.h>
 #include "spade.lexer.h"
 #include "spade.parser.h"
+#include "spade.flat.h"
 #include "spade.symbol.h"
 #include "spade.semantic.h"
 #include "spade.ir.h"
+#include "spade.opt.h"
 #include "spade.vm.h"
+#include "spade.image.h"
+#include "spade.cache.h"
+#include "spade.output.h"
 
-#define MAX_TOKENS 1024
-Token token_array[MAX_TOKENS];
-int token_count = 0;
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+
+int use_register_vm = 0;    // --register: run the register-based tier instead of the stack VM
+int optimization_level = 0; // -O<level>: IR optimization passes to run (0 = none)
+int job_count = 1;          // -j <N>: number of files compiled concurrently
+
+#define DUMP_TOKENS 0x1  // --dump-tokens: print every token
+#define DUMP_AST    0x2  // --dump-ast: print the AST and the symbol table
+#define DUMP_IR     0x4  // --dump-ir: print the optimized IR (and the register code with --register)
+#define DUMP_VM     0x8  // --dump-vm: print the VM state after execution
+#define DUMP_ALL    (DUMP_TOKENS | DUMP_AST | DUMP_IR | DUMP_VM)
+
+int verbose = 1;            // Print stage banners and progress messages (off under `spade run`)
+int dump_flags = DUMP_ALL;  // Debug dumps to print; `spade run` starts with none
+int compile_only = 0;       // `spade compile`: save each program as an image instead of running it
+const char *output_path = NULL; // -o <path>: image path for `spade compile` (single input only)
+int use_cache = 1;          // `spade run` reuses cached images of unchanged sources (--no-cache turns it off)
+
+#define MAX_JOBS 256
 
 /**
  * Tokenizes a source file and outputs token information for debugging.
  * 
- * This function performs lexical analysis on the specified file and prints
- * each token along with its type. It also displays the total token count.
+ * This function streams every token of the lexer's source and prints it
+ * along with its type, displays the total token count, and then rewinds the
+ * lexer so the parser can read the same tokens again.
+ * 
+ * @param lexer An open lexer positioned at the start of its source
+ * @return The number of tokens in the source, excluding the EOF token
+ */
+int tokenize_file(Lexer *lexer){
+    int token_count = 0;
+    for (Token token = next_token(lexer); token.type != TOKEN_EOF; token = next_token(lexer)) {
+        print_token(token);
+        token_count++;
+    }
+    spade_printf("Token Count: %d\n", token_count);
+    rewind_lexer(lexer);
+    return token_count;
+}
+
+
+/**
+ * Executes generated IR code and reports the result.
+ * 
+ * Runs the code on the stack VM, or lowers it to register code first when
+ * --register was given, then prints the final VM state on success if VM
+ * dumps are enabled. Execution errors are always reported.
+ * 
+ * @param ir_code The IR code to execute (must end with IR_HALT)
+ * @return 1 if the program ran to completion, 0 on an error
+ */
+int run_ir_code(IRCode *ir_code){
+    VirtualMachine vm = createVirtualMachine();
+    if (vm.machine_state == ERROR) {
+        spade_printf("Error: Failed to create virtual machine\n");
+        return 0;
+    }
+
+    VMResult result;
+    if (use_register_vm) {
+        RegCode *reg_code = lower_ir_to_reg(ir_code);
+        if (!reg_code) {
+            spade_printf("Error: Failed to lower IR to register code\n");
+            free_VM(&vm);
+            return 0;
+        }
+        if (dump_flags & DUMP_IR) print_reg_code(reg_code);
+        result = execute_reg_code(&vm, reg_code);
+        free_reg_code(reg_code);
+    } else {
+        result = execute_ir_code(&vm, ir_code);
+    }
+
+    if (result == VM_SUCCESS) {
+        if (verbose) spade_printf("Program executed successfully!\n");
+        if (dump_flags & DUMP_VM) print_VM_state(&vm);
+    } else {
+        spade_printf("Error executing program: %d\n", result);
+    }
+    free_VM(&vm);
+    return result == VM_SUCCESS;
+}
+
+
+/**
+ * Runs the front end on one source file: lexing, parsing, semantic
+ * analysis, IR generation and optimization.
+ * 
+ * All pipeline state (token stream, symbol table and AST) is local to the
+ * call, so several files can be compiled concurrently on different threads.
+ * Output goes to the calling thread's output stream. Stage banners and debug
+ * dumps are printed according to verbose and dump_flags; errors always are.
+ * 
+ * @param lexer An open lexer positioned at the start of the source (the caller closes it)
+ * @param filename The path to the source file, for messages
+ * @param error_count Receives the number of semantic errors reported
+ * @return The optimized IR code ending with IR_HALT, or NULL if the file failed to parse
+ */
+IRCode *compile_source(Lexer *lexer, const char *filename, int *error_count){
+    SymbolTable symbol_table = {0};
+    IRCode *ir_code = NULL;
+    *error_count = 0;
+
+    if (verbose) spade_printf("=== LEXER OUTPUT ===\n");
+
+    // Listing the tokens costs a whole extra lexing pass, so only do it when asked
+    if (dump_flags & DUMP_TOKENS) {
+        int token_count = tokenize_file(lexer);
+        if(token_count < 1){
+            spade_printf("Error: No tokens found in file <%s>.\n", filename);
+        }
+    }
+
+    if (verbose) spade_printf("\n=== PARSER OUTPUT ===\n");
+    Parser parser;
+    init_parser(&parser, lexer);
+    ASTNode *root = parse_program(&parser);
+
+    if(root){
+        if (verbose) {
+            spade_printf("Successfully parsed program with %d statements!\n", 
+                   root->data.program.statement_count);
+        }
+        if (dump_flags & DUMP_AST) print_AST(root, 0);
+
+        // Later passes scan the flat form; it lives in the parser's arena
+        FlatAST *flat = flatten_AST(root, &parser.arena);
+        *error_count = analyze_AST(flat, &symbol_table);
+        if (dump_flags & DUMP_AST) print_symbol_table(&symbol_table);
+
+        // Generate IR code
+        if (verbose) spade_printf("\n=== IR GENERATION ===\n");
+        ir_code = create_ir_code();
+        generate_ir(flat, ir_code, &symbol_table);
+        emit_instruction(ir_code, IR_HALT);  // End marker
+        optimize_ir(ir_code, optimization_level);
+        if (dump_flags & DUMP_IR) print_ir_code(ir_code);
+    }else{
+        spade_printf("Failed to parse program\n");
+    }
+    free_parser(&parser);  // Releases the whole AST
+
+    free_symbol_table(&symbol_table);
+    return ir_code;
+}
+
+/**
+ * Checks whether a path names a compiled image rather than source code.
+ * 
+ * @param filename The path to check
+ * @return 1 if the path ends with the image extension, 0 otherwise
+ */
+int is_image_file(const char *filename){
+    size_t length = strlen(filename);
+    size_t extension_length = strlen(SPADE_IMAGE_EXTENSION);
+    return length > extension_length &&
+           strcmp(filename + length - extension_length, SPADE_IMAGE_EXTENSION) == 0;
+}
+
+/**
+ * Picks the image path `spade compile` writes for a source file: the -o
+ * path if one was given, otherwise the source path with its .sp extension
+ * replaced by .spc (or .spc appended).
+ * 
+ * @param filename The source file being compiled
+ * @return The image path (free with free)
+ */
+char *image_path_for(const char *filename){
+    if (output_path) return strdup(output_path);
+
+    size_t length = strlen(filename);
+    if (length > 3 && strcmp(filename + length - 3, ".sp") == 0) length -= 3;
+    char *path = malloc(length + strlen(SPADE_IMAGE_EXTENSION) + 1);
+    memcpy(path, filename, length);
+    strcpy(path + length, SPADE_IMAGE_EXTENSION);
+    return path;
+}
+
+/**
+ * Checks a loaded image before anything reads its instructions.
+ * 
+ * Images are executed in place, and the register tier and the IR printer
+ * trust their input, so the verifier has to accept the code first.
+ * 
+ * @param ir_code The loaded image, or NULL if loading failed
+ * @param filename The image's path, for the error message
+ * @return ir_code if it verified, otherwise NULL (the code has been freed)
+ */
+IRCode *verify_image(IRCode *ir_code, const char *filename){
+    int max_stack_depth;
+    if (ir_code && verify_ir_code(ir_code, &max_stack_depth, 1) != VM_SUCCESS) {
+        spade_printf("Error: Image <%s> failed verification\n", filename);
+        free_ir_code(ir_code);
+        return NULL;
+    }
+    return ir_code;
+}
+
+/**
+ * Compiles a source file through the compilation cache.
+ * 
+ * A hit loads the cached image and skips the front end, so diagnostics the
+ * front end would print (only warnings, since entries are error-free) are
+ * not repeated. A miss compiles the file and caches the result if it had
+ * no errors and verifies.
+ * 
+ * The key is computed from the lexer's buffer, the same bytes a miss
+ * compiles, so an entry always holds the IR of the text it is keyed on. An
+ * entry recorded for a different text (a hash collision) is a miss and is
+ * replaced.
+ * 
+ * @param lexer An open lexer positioned at the start of the source (the caller closes it)
+ * @param filename The path to the source file, for messages
+ * @param error_count Receives the number of semantic errors reported (0 on a hit)
+ * @return The IR code to run, or NULL if the file failed to parse
+ */
+IRCode *compile_source_cached(Lexer *lexer, const char *filename, int *error_count){
+    char *path = cache_image_path(&lexer->source, optimization_level);
+    IRCode *ir_code = path ? verify_image(load_cached_image(path, &lexer->source), path) : NULL;
+    if (ir_code) {
+        *error_count = 0;
+        if (dump_flags & DUMP_IR) print_ir_code(ir_code);
+        free(path);
+        return ir_code;
+    }
+
+    ir_code = compile_source(lexer, filename, error_count);
+    // Code that fails verification is left for the VM to report
+    int max_stack_depth;
+    if (path && ir_code && *error_count == 0 && verify_ir_code(ir_code, &max_stack_depth, 0) == VM_SUCCESS) {
+        store_cached_image(ir_code, path, &lexer->source);
+    }
+    free(path);
+    return ir_code;
+}
+
+/**
+ * Processes one input file according to the driver mode.
+ * 
+ * Source files go through the front end; compiled images (.spc) are loaded
+ * directly and skip it. `spade run` looks source files up in the
+ * compilation cache first unless front-end dumps were requested. Under
+ * `spade compile` the IR is verified and saved as an image instead of being
+ * executed, and nothing is written if the source had errors. Source with
+ * errors is never executed either.
+ * 
+ * @param filename The path to the source file or image
+ * @return 1 on success, 0 if the file had errors, failed to run or its image was not written
+ */
+int compile_file(const char *filename){
+    if (verbose) spade_printf("File: %s \n", filename);
+
+    int error_count = 0;
+    IRCode *ir_code;
+    if (is_image_file(filename)) {
+        if (compile_only) {
+            spade_printf("Error: <%s> is already compiled\n", filename);
+            return 0;
+        }
+        ir_code = verify_image(load_ir_image(filename), filename);
+        if (ir_code && (dump_flags & DUMP_IR)) print_ir_code(ir_code);
+    } else {
+        Lexer lexer;
+        if (!open_lexer(&lexer, filename)) return 0;
+        if (use_cache && !compile_only && !verbose && !(dump_flags & (DUMP_TOKENS | DUMP_AST))) {
+            ir_code = compile_source_cached(&lexer, filename, &error_count);
+        } else {
+            ir_code = compile_source(&lexer, filename, &error_count);
+        }
+        close_lexer(&lexer);
+    }
+    if (!ir_code) return 0;
+
+    int succeeded = 0;
+    if (compile_only) {
+        int max_stack_depth;
+        if (error_count > 0) {
+            spade_printf("Error: <%s> has %d error(s); no image written\n", filename, error_count);
+        } else if (verify_ir_code(ir_code, &max_stack_depth, 1) != VM_SUCCESS) {
+            spade_printf("Error: IR code failed verification; no image written\n");
+        } else {
+            char *path = image_path_for(filename);
+            succeeded = save_ir_image(ir_code, path);
+            if (succeeded && verbose) {
+                spade_printf("Wrote %s\n", path);
+            }
+            free(path);
+        }
+    } else if (error_count > 0) {
+        // Ill-typed code has no defined behavior (a string used as a loop condition can spin forever)
+        spade_printf("Error: <%s> has %d error(s); not executed\n", filename, error_count);
+    } else {
+        // Execute IR code on Virtual Machine
+        if (verbose) spade_printf("\n=== VM EXECUTION ===\n");
+        succeeded = run_ir_code(ir_code);
+    }
+
+    // Clean up
+    free_ir_code(ir_code);
+    return succeeded;
+}
+
+
+/**
+ * Work shared by the threads of a parallel (-j) compilation.
+ * 
+ * Workers take the next unclaimed file under the lock, compile it with their
+ * output captured in a temporary file, and store that file in outputs so the
+ * main thread can print every job's output in input order. Each job also
+ * records whether its file succeeded; only that job's worker writes its entry.
+ */
+typedef struct {
+    char **files;           // Source files to compile
+    int file_count;
+    int next_file;          // Index of the next file to hand out (guarded by lock)
+    FILE **outputs;         // Captured output of each file, or NULL if it went straight to stdout
+    int *succeeded;         // compile_file's result for each file
+#ifdef _WIN32
+    CRITICAL_SECTION lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} JobQueue;
+
+/**
+ * Claims the next file to compile.
+ * 
+ * @param queue The shared job queue
+ * @return The index of the claimed file, or -1 when every file has been handed out
+ */
+int claim_job(JobQueue *queue){
+#ifdef _WIN32
+    EnterCriticalSection(&queue->lock);
+#else
+    pthread_mutex_lock(&queue->lock);
+#endif
+    int index = queue->next_file < queue->file_count ? queue->next_file++ : -1;
+#ifdef _WIN32
+    LeaveCriticalSection(&queue->lock);
+#else
+    pthread_mutex_unlock(&queue->lock);
+#endif
+    return index;
+}
+
+/**
+ * Worker thread body: compiles files until the queue is empty.
+ * 
+ * If a temporary file cannot be created for a job, its output is written to
+ * stdout directly and may interleave with other jobs.
  * 
- * @param filename The path to the source file to be tokenized
+ * @param queue The shared job queue
  */
-void tokenize_file(char *filename){
-    token_count = lexer(filename, token_array, MAX_TOKENS);
-    for (int i = 0; i < token_count; i++)  print_token(token_array[i]);
-    printf("Token Count: %d\n", token_count);
+void run_jobs(JobQueue *queue){
+    int index;
+    while((index = claim_job(queue)) >= 0){
+        FILE *output = tmpfile();
+        set_thread_output(output);
+        queue->succeeded[index] = compile_file(queue->files[index]);
+        set_thread_output(NULL);
+        queue->outputs[index] = output;
+    }
+}
+
+#ifdef _WIN32
+DWORD WINAPI job_thread(LPVOID queue){
+    run_jobs(queue);
+    return 0;
+}
+#else
+void *job_thread(void *queue){
+    run_jobs(queue);
+    return NULL;
+}
+#endif
+
+/**
+ * Compiles several files concurrently on a pool of worker threads.
+ * 
+ * Each file is an independent job. Job output is captured per file and
+ * printed in the order the files were given once all jobs have finished,
+ * so the combined output matches a sequential run.
+ * 
+ * @param files The source files to compile
+ * @param file_count The number of files
+ * @param thread_count The number of worker threads to start
+ * @return The number of files that failed
+ */
+int compile_files_parallel(char **files, int file_count, int thread_count){
+    JobQueue queue;
+    queue.files = files;
+    queue.file_count = file_count;
+    queue.next_file = 0;
+    queue.outputs = calloc(file_count, sizeof(FILE *));
+    queue.succeeded = calloc(file_count, sizeof(int));
+    if(thread_count > file_count) thread_count = file_count;
+#ifdef _WIN32
+    InitializeCriticalSection(&queue.lock);
+    HANDLE *threads = malloc(sizeof(HANDLE) * thread_count);
+#else
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_t *threads = malloc(sizeof(pthread_t) * thread_count);
+#endif
+    if(!queue.outputs || !queue.succeeded || !threads){
+        spade_printf("Error: Failed to allocate job state\n");
+        free(queue.outputs);
+        free(queue.succeeded);
+        free(threads);
+        return file_count;
+    }
+
+    int started = 0;
+    for(int i = 0; i < thread_count; i++){
+#ifdef _WIN32
+        threads[started] = CreateThread(NULL, 0, job_thread, &queue, 0, NULL);
+        if(threads[started] != NULL) started++;
+#else
+        if(pthread_create(&threads[started], NULL, job_thread, &queue) == 0) started++;
+#endif
+    }
+    if(started == 0){
+        run_jobs(&queue); // No worker could be started; compile on this thread instead
+    }
+    for(int i = 0; i < started; i++){
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    // Print each job's captured output in input order
+    char buffer[8192];
+    int failures = 0;
+    for(int i = 0; i < file_count; i++){
+        if(!queue.succeeded[i]) failures++;
+        FILE *output = queue.outputs[i];
+        if(!output) continue;
+        rewind(output);
+        size_t read;
+        while((read = fread(buffer, 1, sizeof(buffer), output)) > 0){
+            fwrite(buffer, 1, read, stdout);
+        }
+        fclose(output);
+    }
+
+#ifdef _WIN32
+    DeleteCriticalSection(&queue.lock);
+#else
+    pthread_mutex_destroy(&queue.lock);
+#endif
+    free(threads);
+    free(queue.outputs);
+    free(queue.succeeded);
+    return failures;
 }
 
 
@@ -36,20 +487,105 @@ void tokenize_file(char *filename){
  * 3. Semantic analysis (type checking and symbol validation)
  * 4. Memory cleanup
  * 
+ * `spade run <files>` executes the files quietly: only errors are printed,
+ * plus whichever debug dumps are requested. `spade compile <files>` runs
+ * the front end and saves each program as a .spc image, which `spade run`
+ * then executes without re-compiling. `spade run` also caches the image of
+ * every source file it compiles cleanly and reuses it while the file, the
+ * compiler and the -O level are unchanged. Without a command every stage is
+ * dumped, as for a debugging session.
+ * 
+ * Options:
+ *   --dump-tokens, --dump-ast, --dump-ir, --dump-vm
+ *                Print the token list, AST and symbol table, IR, or final VM state
+ *   -O0 to -O2   Select the IR optimization level (-O is -O1, default -O0)
+ *   --register   Execute on the register-based VM tier
+ *   -j <N>       Compile up to N files concurrently (output is still printed in input order)
+ *   -o <path>    Image path for `spade compile` (one input file only; default <file>.spc)
+ *   --no-cache   Always compile sources under `spade run`, without reading or writing the cache
+ * 
  * @param argc The number of command-line arguments
  * @param argv Array of command-line argument strings
- * @return 0 on success, 1 on usage error
+ * @return 0 on success, 1 on usage error or if any file failed to compile or run
  */
 int main(int argc, char *argv[]){
 
-    if(argc == 1){
-        printf("Spade Compiler REPL - Enter Spade code (type 'exit' to quit)\n");
-        printf("Use '\\' at end of line to continue on next line\n");
+    char **files = malloc(sizeof(char *) * argc);
+    int file_count = 0;
+    int first_arg = 1;
+    int run_mode = argc > 1 && strcmp(argv[1], "run") == 0;
+    compile_only = argc > 1 && strcmp(argv[1], "compile") == 0;
+    if(run_mode || compile_only){
+        verbose = 0;
+        dump_flags = 0;
+        first_arg = 2;
+    }
+    for(int i = first_arg; i < argc; i++){
+        if(strcmp(argv[i], "--register") == 0){
+            use_register_vm = 1;
+        }else if(strcmp(argv[i], "--dump-tokens") == 0){
+            dump_flags |= DUMP_TOKENS;
+        }else if(strcmp(argv[i], "--dump-ast") == 0){
+            dump_flags |= DUMP_AST;
+        }else if(strcmp(argv[i], "--dump-ir") == 0){
+            dump_flags |= DUMP_IR;
+        }else if(strcmp(argv[i], "--dump-vm") == 0){
+            dump_flags |= DUMP_VM;
+        }else if(strcmp(argv[i], "--no-cache") == 0){
+            use_cache = 0;
+        }else if(strcmp(argv[i], "-O") == 0){
+            optimization_level = 1;
+        }else if(strncmp(argv[i], "-O", 2) == 0 && argv[i][2] >= '0' && argv[i][2] <= '2' && argv[i][3] == '\0'){
+            optimization_level = argv[i][2] - '0';
+        }else if(strncmp(argv[i], "-j", 2) == 0){
+            // -j N or -jN
+            const char *count = argv[i][2] != '\0' ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            char *end;
+            long jobs = strtol(count, &end, 10);
+            if(*count == '\0' || *end != '\0' || jobs < 1 || jobs > MAX_JOBS){
+                spade_printf("Invalid job count for -j: expected 1 to %d\n", MAX_JOBS);
+                free(files);
+                return 1;
+            }
+            job_count = (int)jobs;
+        }else if(strcmp(argv[i], "-o") == 0 && compile_only){
+            if(i + 1 >= argc){
+                spade_printf("Missing path after -o\n");
+                free(files);
+                return 1;
+            }
+            output_path = argv[++i];
+        }else if(argv[i][0] == '-'){
+            spade_printf("Unknown option: %s\n", argv[i]);
+            free(files);
+            return 1;
+        }else{
+            files[file_count++] = argv[i];
+        }
+    }
+
+    if(run_mode && file_count == 0){
+        spade_printf("Usage: %s run [options] <filename>...\n", argv[0]);
+        free(files);
+        return 1;
+    }
+
+    if(compile_only && (file_count == 0 || (output_path && file_count > 1))){
+        spade_printf("Usage: %s compile [options] <filename> [-o <image>]\n", argv[0]);
+        spade_printf("       %s compile [options] <filename>...\n", argv[0]);
+        free(files);
+        return 1;
+    }
+
+    if(file_count == 0){
+        spade_printf("Spade Compiler REPL - Enter Spade code (type 'exit' to quit)\n");
+        SymbolTable repl_symbol_table = {0};  // Declarations persist across inputs
+        spade_printf("Use '\\' at end of line to continue on next line\n");
         char input[4096];
         char line[1024];
         
         while(1){
-            printf("spade> ");
+            spade_printf("spade> ");
             fflush(stdout);
             
             input[0] = '\0';  // Clear input buffer
@@ -73,7 +609,7 @@ int main(int argc, char *argv[]){
                 if(len > 0 && line[len-1] == '\\'){
                     line[len-1] = ' ';  // Replace \ with space
                     strcat(input, line);
-                    printf("spade> ");  // Continuation prompt
+                    spade_printf("spade> ");  // Continuation prompt
                     fflush(stdout);
                 } else {
                     strcat(input, line);
@@ -88,130 +624,88 @@ int main(int argc, char *argv[]){
             // Write input to temporary file
             FILE *temp_file = fopen("temp.sp", "w");
             if(!temp_file){
-                printf("Error: Could not create temporary file\n");
+                spade_printf("Error: Could not create temporary file\n");
                 continue;
             }
             fprintf(temp_file, "%s", input);
             fclose(temp_file);
             
             // Process the input
-            printf("=== LEXER OUTPUT ===\n");
-            tokenize_file("temp.sp");
+            spade_printf("=== LEXER OUTPUT ===\n");
+            Lexer lexer;
+            open_lexer(&lexer, "temp.sp");
+            int token_count = tokenize_file(&lexer);
             
             if(token_count < 1){
-                printf("Error: No tokens generated\n");
+                spade_printf("Error: No tokens generated\n");
+                close_lexer(&lexer);
                 continue;
             }
             
-            printf("\n=== PARSER OUTPUT ===\n");
-            Parser parser = {token_array, 0, token_count};
+            spade_printf("\n=== PARSER OUTPUT ===\n");
+            Parser parser;
+            init_parser(&parser, &lexer);
             ASTNode *root = parse_program(&parser);
             
             if(root){
-                printf("Successfully parsed program with %d statements!\n", 
+                spade_printf("Successfully parsed program with %d statements!\n", 
                        root->data.program.statement_count);
                 print_AST(root, 0);
-                analyze_AST(root, &global_symbol_table);
-                print_symbol_table(&global_symbol_table);
+
+                // Later passes scan the flat form; it lives in the parser's arena
+                FlatAST *flat = flatten_AST(root, &parser.arena);
+                int error_count = analyze_AST(flat, &repl_symbol_table);
+                print_symbol_table(&repl_symbol_table);
 
                 // Generate and execute IR
-                printf("\n=== VM EXECUTION ===\n");
-                VirtualMachine vm = createVirtualMachine();
-                
-                printf("\n=== IR GENERATION ===\n");
+                spade_printf("\n=== IR GENERATION ===\n");
                 IRCode *ir_code = create_ir_code();
-                generate_ir(root, ir_code, &global_symbol_table);
+                generate_ir(flat, ir_code, &repl_symbol_table);
                 emit_instruction(ir_code, IR_HALT);  // End marker
+                optimize_ir(ir_code, optimization_level);
                 print_ir_code(ir_code);
                 
-                if (vm.machine_state == ERROR) {
-                    printf("Error: Failed to create virtual machine\n");
+                spade_printf("\n=== VM EXECUTION ===\n");
+                if (error_count > 0) {
+                    spade_printf("Error: Input has %d error(s); not executed\n", error_count);
                 } else {
-                    VMResult result = execute_ir_code(&vm, ir_code);
-                    if (result != VM_SUCCESS) {
-                        printf("Error executing program: %d\n", result);
-                    } else {
-                        printf("Program executed successfully!\n");
-                    }
-                    print_VM_state(&vm);
+                    run_ir_code(ir_code);
                 }
                 
                 // Cleanup
-                free_AST(root);
                 free_ir_code(ir_code);
-                free_VM(&vm);
             } else {
-                printf("Parse error\n");
+                spade_printf("Parse error\n");
             }
+            free_parser(&parser);
+            close_lexer(&lexer);
             
-            printf("\n");
+            spade_printf("\n");
         }
         
         exit_repl:
         // Clean up temp file
         remove("temp.sp");
+        free_symbol_table(&repl_symbol_table);
+        free(files);
         return 0;
     }
     
     if(argc < 2){
-        printf("Usage: %s <filename>/<path/to/file>\n", argv[0]);
+        spade_printf("Usage: %s <filename>/<path/to/file>\n", argv[0]);
         return 1;
     }
     
 
-    for(int i = 1; i < argc; i++){
-        printf("File: %s \n", argv[i]);
-        printf("=== LEXER OUTPUT ===\n");
-        tokenize_file(argv[i]);
-    
-        if(token_count < 1){
-            printf("Error: No tokens found in file <%s>.\n", argv[i]);
+    int failures = 0;
+    if(job_count > 1){
+        failures = compile_files_parallel(files, file_count, job_count);
+    }else{
+        for(int i = 0; i < file_count; i++){
+            if(!compile_file(files[i])) failures++;
         }
-    
-        printf("\n=== PARSER OUTPUT ===\n");
-        Parser parser = {token_array, 0, token_count};
-        ASTNode *root = parse_program(&parser);
-    
-        if(root){
-            printf("Successfully parsed program with %d statements!\n", 
-                   root->data.program.statement_count);
-            print_AST(root, 0);
-            analyze_AST(root, &global_symbol_table);
-            print_symbol_table(&global_symbol_table);
-
-            // NEW: Execute IR code on Virtual Machine
-            printf("\n=== VM EXECUTION ===\n");
-            VirtualMachine vm = createVirtualMachine();
-            
-            // NEW: Generate IR code
-            printf("\n=== IR GENERATION ===\n");
-            IRCode *ir_code = create_ir_code();
-            generate_ir(root, ir_code, &global_symbol_table);
-            emit_instruction(ir_code, IR_HALT);  // End marker
-            print_ir_code(ir_code);
-            if (vm.machine_state == ERROR) {
-                printf("Error: Failed to create virtual machine\n");
-            } else {
-                VMResult result = execute_ir_code(&vm, ir_code);
-                if (result == VM_SUCCESS) {
-                    printf("Program executed successfully!\n");
-                    print_VM_state(&vm);
-                } else {
-                    printf("Error executing program: %d\n", result);
-                }
-                free_VM(&vm);
-            }
-
-            // Clean up
-            free_AST(root);
-            free_symbol_table(&global_symbol_table);
-            free_ir_code(ir_code);
-        }else{
-            printf("Failed to parse program\n");
-        }
-        
-        free_tokens(token_array, token_count);
     }
+    free(files);
     
-    return 0;
+    return failures > 0 ? 1 : 0;
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "spade.cache.h"
+#include "spade.image.h"
+#include "spade.lexer.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define make_directory(path) _mkdir(path)
+#define process_id() _getpid()
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#define make_directory(path) mkdir(path, 0755)
+#define process_id() getpid()
+#endif
+
+/**
+ * Identifies the compiler build in cache keys. CMake generates it as a hash
+ * of the compiler's sources, so a compiler built from changed sources
+ * ignores entries its predecessors wrote while identical sources still
+ * build identical binaries. Builds without it rely on SPADE_IMAGE_VERSION
+ * alone to tell entries apart.
+ */
+#ifdef SPADE_HAVE_BUILD_ID
+#include "spade.build_id.h"
+#else
+#define SPADE_BUILD_ID "unversioned"
+#endif
+
+/**
+ * Continues a 64-bit FNV-1a hash over a block of bytes.
+ *
+ * @param hash The hash so far (start from 14695981039346656037)
+ * @param bytes The bytes to add
+ * @param length Number of bytes
+ * @return The updated hash
+ */
+unsigned long long cache_hash(unsigned long long hash, const void *bytes, size_t length) {
+    const unsigned char *p = bytes;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * Scrambles a 64-bit word (the splitmix64 finalizer).
+ *
+ * @param value The word to scramble
+ * @return The scrambled word
+ */
+unsigned long long cache_mix(unsigned long long value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    value ^= value >> 31;
+    return value;
+}
+
+/**
+ * Computes the digest a cache entry records of its source.
+ *
+ * Entries are found by an FNV-1a hash of the source, which is cheap to
+ * collide on purpose. This digest works a word at a time through a
+ * different mixing function, so a source crafted to collide with the
+ * lookup hash still has to match it and the length before a hit is used.
+ *
+ * @param bytes The source text
+ * @param length Number of bytes
+ * @return The digest
+ */
+unsigned long long cache_digest(const void *bytes, size_t length) {
+    const unsigned char *p = bytes;
+    unsigned long long digest = cache_mix(0x9e3779b97f4a7c15ull ^ (unsigned long long)length);
+    unsigned long long word;
+    size_t i = 0;
+    for (; i + sizeof(word) <= length; i += sizeof(word)) {
+        memcpy(&word, p + i, sizeof(word));
+        digest = cache_mix(digest ^ cache_mix(word));
+    }
+    word = 0;
+    if (i < length) memcpy(&word, p + i, length - i);
+    return cache_mix(digest ^ cache_mix(word ^ 0x2545f4914f6cdd1dull));
+}
+
+/**
+ * Creates a directory and any missing parents.
+ *
+ * @param path The directory to create (modified temporarily, restored on return)
+ * @return 1 if the directory exists afterwards, 0 otherwise
+ */
+int make_directories(char *path) {
+    for (char *p = path + 1; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            char separator = *p;
+            *p = '\0';
+            make_directory(path);
+            *p = separator;
+        }
+    }
+    return make_directory(path) == 0 || errno == EEXIST;
+}
+
+/**
+ * Finds the cache directory, creating it if needed.
+ *
+ * @return The directory's path (caller frees), or NULL if there is no usable cache directory
+ */
+char *cache_directory(void) {
+    const char *base = getenv("SPADE_CACHE_DIR");
+    const char *suffix = "";
+    if (!base || !*base) {
+#ifdef _WIN32
+        base = getenv("LOCALAPPDATA");
+        suffix = "\\spade";
+#else
+        base = getenv("XDG_CACHE_HOME");
+        suffix = "/spade";
+        if (!base || !*base) {
+            base = getenv("HOME");
+            suffix = "/.cache/spade";
+        }
+#endif
+    }
+    if (!base || !*base) return NULL;
+
+    char *directory = malloc(strlen(base) + strlen(suffix) + 1);
+    if (!directory) return NULL;
+    strcpy(directory, base);
+    strcat(directory, suffix);
+
+    if (!make_directories(directory)) {
+        free(directory);
+        return NULL;
+    }
+    return directory;
+}
+
+/**
+ * Picks the cache entry for a source text.
+ *
+ * The key covers everything that determines the generated IR: the source
+ * text, the compiler build, the image format and the optimization level.
+ * Options applied after loading (such as --register) are not part of it.
+ * The caller passes the buffer it compiles on a miss, so the file changing
+ * in between cannot store IR under another text's key.
+ *
+ * @param source The source text to be run
+ * @param optimization_level The -O level the text is compiled at
+ * @return The path of the text's cache entry (caller frees), or NULL if there is no cache directory
+ */
+char *cache_image_path(const SourceBuffer *source, int optimization_level) {
+    unsigned int format[3] = { SPADE_IMAGE_VERSION, SPADE_IMAGE_BYTE_ORDER, (unsigned int)optimization_level };
+    unsigned long long hash = 14695981039346656037ull;
+    hash = cache_hash(hash, SPADE_BUILD_ID, sizeof(SPADE_BUILD_ID));
+    hash = cache_hash(hash, format, sizeof(format));
+    hash = cache_hash(hash, source->data, source->size);
+
+    char *directory = cache_directory();
+    if (!directory) return NULL;
+
+    // <directory>/<16 hex digits>.spc
+    char *path = malloc(strlen(directory) + 1 + 16 + strlen(SPADE_IMAGE_EXTENSION) + 1);
+    if (path) {
+        sprintf(path, "%s/%016llx%s", directory, hash, SPADE_IMAGE_EXTENSION);
+    }
+    free(directory);
+    return path;
+}
+
+/**
+ * Loads a cache entry if there is one for a source text.
+ *
+ * An entry whose recorded source size or digest differs from the text's
+ * was stored for another source whose hash collided, and counts as a miss.
+ *
+ * @param path The entry's path from cache_image_path
+ * @param source The source text the entry was looked up for
+ * @return The cached IR code (not yet verified), or NULL on a miss
+ */
+IRCode *load_cached_image(const char *path, const SourceBuffer *source) {
+    // A missing entry is the normal miss; only report problems with entries that exist
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fclose(file);
+
+    IRCode *code = load_ir_image(path);
+    if (code && (code->source_size != (unsigned int)source->size ||
+                 code->source_digest != cache_digest(source->data, source->size))) {
+        free_ir_code(code);
+        return NULL;
+    }
+    return code;
+}
+
+/**
+ * Saves compiled IR code as a cache entry.
+ *
+ * The image is written under a name unique to this process and call, then
+ * renamed over the entry, so readers only ever see complete images. Where
+ * rename cannot replace an existing file (Windows), the entry another run
+ * stored first is kept.
+ *
+ * @param code Verified IR code ending with IR_HALT
+ * @param path The entry's path from cache_image_path
+ * @param source The source text the code was compiled from, recorded for load_cached_image to check
+ */
+void store_cached_image(IRCode *code, const char *path, const SourceBuffer *source) {
+    code->source_size = (unsigned int)source->size;
+    code->source_digest = cache_digest(source->data, source->size);
+
+    char *temporary = malloc(strlen(path) + 64);
+    if (!temporary) return;
+    // The code's address keeps names apart between threads of one process
+    sprintf(temporary, "%s.%d.%p.tmp", path, (int)process_id(), (void *)code);
+
+    // An unwritable cache is not an error worth reporting on every run
+    FILE *file = fopen(temporary, "wb");
+    if (!file) {
+        free(temporary);
+        return;
+    }
+    fclose(file);
+
+    if (!save_ir_image(code, temporary) || rename(temporary, path) != 0) {
+        remove(temporary);
+    }
+    free(temporary);
+}
@@ -0,0 +1,31 @@
+#ifndef SPADE_CACHE_H
+#define SPADE_CACHE_H
+
+#include "spade.ir.h"
+#include "spade.lexer.h"
+
+/**
+ * Compilation cache for `spade run`.
+ *
+ * Each source file that compiles cleanly is saved as an image (see
+ * spade.image.h) in a per-user cache directory, named after a 64-bit hash of
+ * the file's contents, the compiler build, the image format and the
+ * options that affect the generated IR. Running an unchanged file again
+ * loads that image and skips the front end entirely.
+ *
+ * The directory is $SPADE_CACHE_DIR if set, otherwise $XDG_CACHE_HOME/spade
+ * or ~/.cache/spade (%LOCALAPPDATA%\spade on Windows). Entries are written
+ * to a temporary file and renamed into place, so concurrent runs never see
+ * a partial image. Nothing is ever evicted; deleting the directory is safe.
+ *
+ * Each entry also records its source's length and a second digest of it,
+ * computed differently from the name's hash; an entry that does not match
+ * the source being run is treated as a miss.
+ */
+
+char *cache_image_path(const SourceBuffer *source, int optimization_level);
+unsigned long long cache_digest(const void *bytes, size_t length);
+IRCode *load_cached_image(const char *path, const SourceBuffer *source);
+void store_cached_image(IRCode *code, const char *path, const SourceBuffer *source);
+
+#endif
@@ -0,0 +1,283 @@
+#include <string.h>
+#include "spade.flat.h"
+
+/**
+ * Makes room for one more element in a side table, doubling it when full.
+ *
+ * @param arena The arena the table lives in
+ * @param array The table's current storage (NULL before the first element)
+ * @param count Number of elements in use
+ * @param capacity In/out: allocated number of elements
+ * @param element_size Size of one element in bytes
+ * @return The table's (possibly moved) storage
+ */
+void *flat_reserve(Arena *arena, void *array, int count, int *capacity, size_t element_size) {
+    if (count < *capacity) return array;
+
+    int new_capacity = *capacity ? *capacity * 2 : 16;
+    array = arena_grow(arena, array, element_size * *capacity, element_size * new_capacity);
+    *capacity = new_capacity;
+    return array;
+}
+
+/**
+ * Appends a node to the flat AST.
+ *
+ * @param flat The flat AST to append to
+ * @param kind The node kind
+ * @param value The node's payload (see FlatAST.values)
+ * @param left Left or only operand index, or -1
+ * @param right Right operand index, or -1
+ * @return The new node's index
+ */
+int add_flat_node(FlatAST *flat, ASTNodeType kind, int value, int left, int right) {
+    if (flat->count >= flat->capacity) {
+        int old = flat->capacity;
+        int grown = old ? old * 2 : 64;
+        flat->kinds = arena_grow(flat->arena, flat->kinds, sizeof(ASTNodeType) * old, sizeof(ASTNodeType) * grown);
+        flat->values = arena_grow(flat->arena, flat->values, sizeof(int) * old, sizeof(int) * grown);
+        flat->lefts = arena_grow(flat->arena, flat->lefts, sizeof(int) * old, sizeof(int) * grown);
+        flat->rights = arena_grow(flat->arena, flat->rights, sizeof(int) * old, sizeof(int) * grown);
+        flat->types = arena_grow(flat->arena, flat->types, sizeof(enum TokenType) * old, sizeof(enum TokenType) * grown);
+        flat->symbols = arena_grow(flat->arena, flat->symbols, sizeof(Symbol *) * old, sizeof(Symbol *) * grown);
+        flat->capacity = grown;
+    }
+
+    int index = flat->count++;
+    flat->kinds[index] = kind;
+    flat->values[index] = value;
+    flat->lefts[index] = left;
+    flat->rights[index] = right;
+    flat->types[index] = -1;
+    flat->symbols[index] = NULL;
+    return index;
+}
+
+/**
+ * Appends an expression tree to the flat AST in post-order.
+ *
+ * @param flat The flat AST to append to
+ * @param node The expression to flatten (may be NULL after a parse error)
+ * @return The index of the expression's root node, or -1 if node is NULL
+ */
+int flatten_expression(FlatAST *flat, ASTNode *node) {
+    if (!node) return -1;
+
+    switch (node->type) {
+        case AST_NUMBER:
+            return add_flat_node(flat, AST_NUMBER, node->data.number.value, -1, -1);
+
+        case AST_BOOLEAN:
+            return add_flat_node(flat, AST_BOOLEAN, node->data.boolean.value, -1, -1);
+
+        case AST_IDENTIFIER:
+            flat->names = flat_reserve(flat->arena, flat->names, flat->name_count,
+                                       &flat->name_capacity, sizeof(const char *));
+            flat->names[flat->name_count] = node->data.identifier.name;
+            return add_flat_node(flat, AST_IDENTIFIER, flat->name_count++, -1, -1);
+
+        case AST_STRING_LITERAL:
+            flat->strings = flat_reserve(flat->arena, flat->strings, flat->string_count,
+                                         &flat->string_capacity, sizeof(FlatString));
+            flat->strings[flat->string_count].value = node->data.string_lit.value;
+            flat->strings[flat->string_count].length = node->data.string_lit.length;
+            return add_flat_node(flat, AST_STRING_LITERAL, flat->string_count++, -1, -1);
+
+        case AST_BINARY_OPERATION: {
+            int left = flatten_expression(flat, node->data.bin_op.left);
+            int right = flatten_expression(flat, node->data.bin_op.right);
+            return add_flat_node(flat, AST_BINARY_OPERATION, node->data.bin_op.op, left, right);
+        }
+
+        case AST_UNARY_OPERATION: {
+            int operand = flatten_expression(flat, node->data.unary_op.operand);
+            return add_flat_node(flat, AST_UNARY_OPERATION, node->data.unary_op.op, operand, -1);
+        }
+
+        case AST_FUNCTION_CALL: {
+            ASTNode *arg_list = node->data.function_call.arguments;
+            int arg_count = arg_list->data.argument_list.argument_count;
+
+            flat->calls = flat_reserve(flat->arena, flat->calls, flat->call_count,
+                                       &flat->call_capacity, sizeof(FlatCall));
+            int call = flat->call_count++;
+            int index = add_flat_node(flat, AST_FUNCTION_CALL, call, -1, -1);
+
+            // Claim the call's argument entries before flattening them, since nested calls add their own
+            int arg_first = flat->arg_count;
+            for (int i = 0; i < arg_count; i++) {
+                flat->args = flat_reserve(flat->arena, flat->args, flat->arg_count,
+                                          &flat->arg_capacity, sizeof(FlatRange));
+                flat->arg_count++;
+            }
+            for (int i = 0; i < arg_count; i++) {
+                int start = flat->count;
+                int root = flatten_expression(flat, arg_list->data.argument_list.arguments[i]->data.argument.value);
+                flat->args[arg_first + i].start = start;
+                flat->args[arg_first + i].root = root;
+            }
+
+            flat->calls[call].name = node->data.function_call.name;
+            flat->calls[call].arg_first = arg_first;
+            flat->calls[call].arg_count = arg_count;
+            flat->calls[call].end = flat->count;
+            return index;
+        }
+
+        default:
+            // AST_NULL and anything unexpected become a leaf the later passes reject
+            return add_flat_node(flat, node->type, 0, -1, -1);
+    }
+}
+
+/**
+ * Appends an empty statement to the flat AST.
+ *
+ * @param flat The flat AST to append to
+ * @param kind The statement kind
+ * @return The new statement's index (its end is the next index until it gets children)
+ */
+int add_flat_statement(FlatAST *flat, ASTNodeType kind) {
+    flat->statements = flat_reserve(flat->arena, flat->statements, flat->statement_count,
+                                    &flat->statement_capacity, sizeof(FlatStatement));
+    int index = flat->statement_count++;
+    FlatStatement *statement = &flat->statements[index];
+    statement->kind = kind;
+    statement->type = -1;
+    statement->name = NULL;
+    statement->expression.start = -1;
+    statement->expression.root = -1;
+    statement->param_first = 0;
+    statement->param_count = 0;
+    statement->end = index + 1;
+    statement->alternative = index + 1;
+    statement->scope = NULL;
+    return index;
+}
+
+/**
+ * Appends an expression to the flat AST and records it as a statement's expression.
+ *
+ * @param flat The flat AST to append to
+ * @param index The statement's index
+ * @param value The expression (nothing is recorded if NULL)
+ */
+void flatten_statement_expression(FlatAST *flat, int index, ASTNode *value) {
+    if (!value) return;
+
+    int start = flat->count;
+    int root = flatten_expression(flat, value);
+    flat->statements[index].expression.start = start;
+    flat->statements[index].expression.root = root;
+}
+
+/**
+ * Appends a statement, and everything nested in it, to the flat AST in pre-order.
+ *
+ * Recursion only follows statement nesting; each expression is still
+ * appended by flatten_expression.
+ *
+ * @param flat The flat AST to append to
+ * @param node The statement to flatten
+ */
+void flatten_statement(FlatAST *flat, ASTNode *node) {
+    // The statement table may move while children are appended, so statements are addressed by index
+    int index = add_flat_statement(flat, node->type);
+
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            flat->statements[index].type = node->data.var_declaration.var_type;
+            flat->statements[index].name = node->data.var_declaration.name;
+            flatten_statement_expression(flat, index, node->data.var_declaration.value);
+            break;
+
+        case AST_ASSIGNMENT:
+            flat->statements[index].name = node->data.variable_assignment.name;
+            flatten_statement_expression(flat, index, node->data.variable_assignment.value);
+            break;
+
+        case AST_FUNCTION_DECLARATION: {
+            ASTNode *param_list = node->data.function_declaration.parameters;
+            FlatStatement *statement = &flat->statements[index];
+            statement->type = node->data.function_declaration.return_type;
+            statement->name = node->data.function_declaration.name;
+            statement->param_first = flat->param_count;
+            statement->param_count = param_list->data.parameter_list.parameter_count;
+            for (int p = 0; p < statement->param_count; p++) {
+                ASTNode *param = param_list->data.parameter_list.parameters[p];
+                flat->params = flat_reserve(flat->arena, flat->params, flat->param_count,
+                                            &flat->param_capacity, sizeof(Param));
+                flat->params[flat->param_count].name = param->data.parameter.name;
+                flat->params[flat->param_count].type = param->data.parameter.type;
+                flat->param_count++;
+            }
+            break;
+        }
+
+        case AST_BLOCK:
+            for (int i = 0; i < node->data.block.statement_count; i++) {
+                flatten_statement(flat, node->data.block.statements[i]);
+            }
+            break;
+
+        case AST_IF:
+            flatten_statement_expression(flat, index, node->data.if_statement.condition);
+            flatten_statement(flat, node->data.if_statement.then_branch);
+            flat->statements[index].alternative = flat->statement_count;
+            if (node->data.if_statement.else_branch) {
+                flatten_statement(flat, node->data.if_statement.else_branch);
+            }
+            break;
+
+        case AST_WHILE:
+            flatten_statement_expression(flat, index, node->data.while_loop.condition);
+            flatten_statement(flat, node->data.while_loop.body);
+            flat->statements[index].alternative = flat->statement_count;
+            break;
+
+        case AST_FOR: {
+            // The block holds the initializer; the loop follows it inside the block
+            flat->statements[index].kind = AST_BLOCK;
+            if (node->data.for_loop.initializer) {
+                flatten_statement(flat, node->data.for_loop.initializer);
+            }
+            int loop = add_flat_statement(flat, AST_FOR);
+            flatten_statement_expression(flat, loop, node->data.for_loop.condition);
+            flatten_statement(flat, node->data.for_loop.body);
+            flat->statements[loop].alternative = flat->statement_count;
+            if (node->data.for_loop.update) {
+                flatten_statement(flat, node->data.for_loop.update);
+            }
+            flat->statements[loop].end = flat->statement_count;
+            break;
+        }
+
+        default:
+            // AST_BREAK and AST_CONTINUE have no operands
+            break;
+    }
+
+    flat->statements[index].end = flat->statement_count;
+}
+
+/**
+ * Converts a parsed program into its flat, index-based form.
+ *
+ * This is the only pass that walks the pointer-based tree; semantic analysis
+ * and IR generation then scan the flat arrays front to back.
+ *
+ * @param program The AST_PROGRAM node returned by parse_program
+ * @param arena The arena to allocate the flat AST from (normally the parser's)
+ * @return The flat AST, valid until the arena is freed
+ */
+FlatAST *flatten_AST(ASTNode *program, Arena *arena) {
+    FlatAST *flat = arena_alloc(arena, sizeof(FlatAST));
+    memset(flat, 0, sizeof(FlatAST));
+    flat->arena = arena;
+
+    for (int i = 0; i < program->data.program.statement_count; i++) {
+        flatten_statement(flat, program->data.program.statements[i]);
+    }
+
+    return flat;
+}
@@ -0,0 +1,146 @@
+#ifndef SPADE_FLAT_H
+#define SPADE_FLAT_H
+
+#include "spade.parser.h"
+#include "spade.arena.h"
+#include "spade.symbol.h"
+
+/**
+ * Flat, index-based form of a parsed program.
+ *
+ * Expressions are stored in post-order as parallel arrays, so an operator
+ * always comes after its operands and a pass over an expression is a single
+ * forward scan. Nodes refer to each other by index instead of by pointer,
+ * and variable-length data lives in side tables.
+ *
+ * Function calls are the one exception to post-order: a call node comes
+ * first, followed by the nodes of its arguments, and calls[].end gives the
+ * index just past them. Scans treat a call as a leaf and jump to end, which
+ * lets each pass decide whether (and when) to visit the arguments.
+ *
+ * Statements are kept in a separate table; each one points at the node range
+ * of its expression. Statements that contain others (blocks, if, while, for)
+ * are stored in pre-order: the statement comes first, followed by everything
+ * nested in it, and its end gives the index just past them. A for loop is
+ * flattened as a block holding its initializer and the loop itself, so the
+ * initializer gets the loop's scope:
+ *
+ *   for (init; cond; update) body   ->   BLOCK, init, FOR(cond), body..., update
+ */
+
+/**
+ * A contiguous range of nodes holding one expression.
+ *
+ * @param start Index of the first node of the expression
+ * @param root Index of the expression's root node (the last one in post-order)
+ */
+typedef struct {
+    int start;
+    int root;
+} FlatRange;
+
+/**
+ * A function call's side-table entry.
+ *
+ * @param name The called function's name
+ * @param arg_first Index of the call's first argument in FlatAST.args
+ * @param arg_count Number of arguments
+ * @param end Index of the first node after the call's arguments
+ */
+typedef struct {
+    const char *name;
+    int arg_first;
+    int arg_count;
+    int end;
+} FlatCall;
+
+/**
+ * A string literal's side-table entry.
+ *
+ * @param value The literal's bytes (may contain NUL bytes)
+ * @param length Length in bytes
+ */
+typedef struct {
+    const char *value;
+    int length;
+} FlatString;
+
+/**
+ * One statement.
+ *
+ * @param kind AST_VARIABLE_DECLARATION, AST_ASSIGNMENT, AST_FUNCTION_DECLARATION,
+ *             AST_BLOCK, AST_IF, AST_WHILE, AST_FOR, AST_BREAK or AST_CONTINUE
+ * @param type Declared variable type or function return type
+ * @param name The declared, assigned or function name
+ * @param expression Node range of the initializer, assigned value or condition; start is -1 when there is none
+ * @param param_first Index of a function's first parameter in FlatAST.params
+ * @param param_count Number of function parameters
+ * @param end Index of the first statement after this one and everything nested in it
+ * @param alternative IF: index of the else branch's first statement; FOR: index of the
+ *                    update statement; either is end when absent (and always for WHILE)
+ * @param scope BLOCK: the scope semantic analysis opened for it; declaration that is the
+ *              unbraced body of an if branch or loop: the scope it was declared in
+ *              (NULL until analyzed, and for everything else)
+ */
+typedef struct {
+    ASTNodeType kind;
+    enum TokenType type;
+    const char *name;
+    FlatRange expression;
+    int param_first;
+    int param_count;
+    int end;
+    int alternative;
+    SymbolTable *scope;
+} FlatStatement;
+
+/**
+ * @param kinds Node kind of every node
+ * @param values Per-node payload: NUMBER/BOOLEAN value, BINARY/UNARY operator token,
+ *               IDENTIFIER index into names, STRING_LITERAL index into strings,
+ *               FUNCTION_CALL index into calls
+ * @param lefts Left operand of a binary operation, or the operand of a unary one (-1 otherwise)
+ * @param rights Right operand of a binary operation (-1 otherwise)
+ * @param types Resolved type of every node, filled in by semantic analysis (-1 until typed or on a type error)
+ * @param symbols Resolved symbol of IDENTIFIER and FUNCTION_CALL nodes, filled in by semantic analysis (NULL otherwise)
+ */
+typedef struct {
+    ASTNodeType *kinds;
+    int *values;
+    int *lefts;
+    int *rights;
+    enum TokenType *types;
+    Symbol **symbols;
+    int count;
+    int capacity;
+
+    const char **names;         // Identifier names
+    int name_count;
+    int name_capacity;
+
+    FlatString *strings;        // String literals
+    int string_count;
+    int string_capacity;
+
+    FlatCall *calls;            // Function calls
+    int call_count;
+    int call_capacity;
+
+    FlatRange *args;            // Call arguments, grouped per call
+    int arg_count;
+    int arg_capacity;
+
+    Param *params;              // Function declaration parameters, grouped per declaration
+    int param_count;
+    int param_capacity;
+
+    FlatStatement *statements;  // Statements in program order, nested ones after their parent
+    int statement_count;
+    int statement_capacity;
+
+    Arena *arena;               // Owns every array above
+} FlatAST;
+
+FlatAST *flatten_AST(ASTNode *program, Arena *arena);
+
+#endif
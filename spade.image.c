@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spade.image.h"
+#include "spade.output.h"
+
+/**
+ * Growable byte buffer an image is assembled in before it is written out.
+ */
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    int failed;             // Set once an allocation fails; later writes are ignored
+} ImageWriter;
+
+/**
+ * Appends raw bytes to an image.
+ *
+ * @param writer The image being written
+ * @param bytes The bytes to append (may be NULL when length is 0)
+ * @param length Number of bytes
+ */
+void image_write_bytes(ImageWriter *writer, const void *bytes, size_t length) {
+    if (writer->failed || length == 0) return;
+
+    if (writer->size + length > writer->capacity) {
+        size_t new_capacity = writer->capacity ? writer->capacity : 256;
+        while (writer->size + length > new_capacity) {
+            new_capacity *= 2;
+        }
+        unsigned char *new_data = realloc(writer->data, new_capacity);
+        if (!new_data) {
+            writer->failed = 1;
+            return;
+        }
+        writer->data = new_data;
+        writer->capacity = new_capacity;
+    }
+
+    memcpy(writer->data + writer->size, bytes, length);
+    writer->size += length;
+}
+
+/**
+ * Pads an image with zero bytes up to the next section boundary.
+ *
+ * @param writer The image being written
+ * @return The offset the next section starts at
+ */
+unsigned int image_start_section(ImageWriter *writer) {
+    static const unsigned char zeros[SPADE_IMAGE_ALIGNMENT] = {0};
+    size_t padding = (SPADE_IMAGE_ALIGNMENT - writer->size % SPADE_IMAGE_ALIGNMENT) % SPADE_IMAGE_ALIGNMENT;
+    image_write_bytes(writer, zeros, padding);
+    return (unsigned int)writer->size;
+}
+
+/**
+ * Writes IR code to a compiled image file.
+ *
+ * @param code The IR code to save (verified, so its bytecode has been packed)
+ * @param path The file to create or overwrite
+ * @return 1 on success, 0 on failure (an error has been printed)
+ */
+int save_ir_image(IRCode *code, const char *path) {
+    ImageWriter writer = {0};
+    ImageWriter text = {0};
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SPADE_IMAGE_MAGIC, 4);
+    header.version = SPADE_IMAGE_VERSION;
+    header.byte_order = SPADE_IMAGE_BYTE_ORDER;
+    header.bytecode_size = code->bytecode_size;
+    header.string_count = code->strings->count;
+    header.slot_count = code->slot_count;
+    header.source_size = code->source_size;
+    memcpy(header.source_digest, &code->source_digest, sizeof(header.source_digest));
+
+    // Filled in again once every offset is known
+    image_write_bytes(&writer, &header, sizeof(header));
+
+    header.bytecode_offset = image_start_section(&writer);
+    image_write_bytes(&writer, code->bytecode, code->bytecode_size);
+
+    header.string_lengths_offset = image_start_section(&writer);
+    image_write_bytes(&writer, code->strings->lengths, sizeof(int) * code->strings->count);
+
+    header.string_offsets_offset = image_start_section(&writer);
+    for (int i = 0; i < code->strings->count; i++) {
+        unsigned int offset = (unsigned int)text.size;
+        image_write_bytes(&writer, &offset, sizeof(offset));
+        // Literals may contain NUL bytes, so the length is what counts; the terminator is for printing
+        image_write_bytes(&text, code->strings->strings[i], code->strings->lengths[i] + 1);
+    }
+
+    header.slot_names_offset = image_start_section(&writer);
+    for (int i = 0; i < code->slot_count; i++) {
+        unsigned int offset = SPADE_IMAGE_NO_NAME;
+        if (code->slot_names[i]) {
+            offset = (unsigned int)text.size;
+            image_write_bytes(&text, code->slot_names[i], strlen(code->slot_names[i]) + 1);
+        }
+        image_write_bytes(&writer, &offset, sizeof(offset));
+    }
+
+    header.slot_flags_offset = image_start_section(&writer);
+    image_write_bytes(&writer, code->slot_is_string, code->slot_count);
+
+    header.text_offset = image_start_section(&writer);
+    header.text_size = (unsigned int)text.size;
+    image_write_bytes(&writer, text.data, text.size);
+    free(text.data);
+
+    if (writer.failed || text.failed) {
+        spade_printf("Error: Out of memory while writing image <%s>\n", path);
+        free(writer.data);
+        return 0;
+    }
+    memcpy(writer.data, &header, sizeof(header));
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        spade_printf("Error: Could not create image <%s>\n", path);
+        free(writer.data);
+        return 0;
+    }
+    int written = fwrite(writer.data, 1, writer.size, file) == writer.size;
+    written = fclose(file) == 0 && written;
+    free(writer.data);
+
+    if (!written) {
+        spade_printf("Error: Could not write image <%s>\n", path);
+        remove(path);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Checks that an array section lies inside an image and is suitably aligned.
+ *
+ * @param size The image size in bytes
+ * @param offset The section's offset
+ * @param count Number of elements
+ * @param element_size Size of one element in bytes
+ * @return 1 if the section fits, 0 otherwise
+ */
+int image_section_fits(size_t size, unsigned int offset, unsigned int count, size_t element_size) {
+    return offset % SPADE_IMAGE_ALIGNMENT == 0 && offset <= size &&
+           count <= (size - offset) / element_size;
+}
+
+/**
+ * Loads a compiled image for execution.
+ *
+ * The file is memory-mapped (see open_source) and the returned IR code
+ * points straight into it: the bytecode, slot flags and string lengths are
+ * used in place, and names and literals are NUL-terminated text inside the
+ * image. The only allocations are one pointer table for the slot names and
+ * one for the literals, so loading costs nothing per instruction. The
+ * instruction array is left empty until something needs it (see
+ * unpack_ir_code).
+ *
+ * The header and section bounds are checked here; the bytecode itself is
+ * untrusted until verify_ir_code has accepted it.
+ *
+ * @param path The image file to load
+ * @return IR code backed by the image (free with free_ir_code), or NULL on failure (an error has been printed)
+ */
+IRCode *load_ir_image(const char *path) {
+    SourceBuffer image;
+    if (!open_source(path, &image)) {
+        spade_printf("Error: Could not read image <%s>\n", path);
+        return NULL;
+    }
+
+    ImageHeader header;
+    if (image.size < sizeof(header) || memcmp(image.data, SPADE_IMAGE_MAGIC, 4) != 0) {
+        spade_printf("Error: <%s> is not a compiled Spade image\n", path);
+        close_source(&image);
+        return NULL;
+    }
+    memcpy(&header, image.data, sizeof(header));
+
+    if (header.byte_order != SPADE_IMAGE_BYTE_ORDER) {
+        spade_printf("Error: Image <%s> was compiled for a different platform; recompile it\n", path);
+        close_source(&image);
+        return NULL;
+    }
+    if (header.version != SPADE_IMAGE_VERSION) {
+        spade_printf("Error: Image <%s> has version %u, expected %d; recompile it\n",
+                     path, header.version, SPADE_IMAGE_VERSION);
+        close_source(&image);
+        return NULL;
+    }
+
+    const char *base = image.data;
+    const char *text = base + header.text_offset;
+    int valid = header.bytecode_size <= 0x7fffffff && header.string_count <= 0x7fffffff &&
+                header.slot_count <= 0x7fffffff &&
+                image_section_fits(image.size, header.bytecode_offset, header.bytecode_size, 1) &&
+                image_section_fits(image.size, header.string_lengths_offset, header.string_count, sizeof(int)) &&
+                image_section_fits(image.size, header.string_offsets_offset, header.string_count, sizeof(unsigned int)) &&
+                image_section_fits(image.size, header.slot_names_offset, header.slot_count, sizeof(unsigned int)) &&
+                image_section_fits(image.size, header.slot_flags_offset, header.slot_count, 1) &&
+                image_section_fits(image.size, header.text_offset, header.text_size, 1) &&
+                // A terminated text section means every in-range offset starts a terminated string
+                (header.text_size == 0 || text[header.text_size - 1] == '\0');
+
+    char **slot_names = NULL;
+    char **strings = NULL;
+    if (valid) {
+        slot_names = malloc(sizeof(char *) * (header.slot_count ? header.slot_count : 1));
+        strings = malloc(sizeof(char *) * (header.string_count ? header.string_count : 1));
+        valid = slot_names && strings;
+    }
+
+    const unsigned int *name_offsets = (const unsigned int *)(base + header.slot_names_offset);
+    for (unsigned int i = 0; valid && i < header.slot_count; i++) {
+        unsigned int offset = name_offsets[i];
+        if (offset == SPADE_IMAGE_NO_NAME) {
+            slot_names[i] = NULL;
+        } else if (offset < header.text_size) {
+            slot_names[i] = (char *)text + offset;
+        } else {
+            valid = 0;
+        }
+    }
+
+    const int *lengths = (const int *)(base + header.string_lengths_offset);
+    const unsigned int *string_offsets = (const unsigned int *)(base + header.string_offsets_offset);
+    for (unsigned int i = 0; valid && i < header.string_count; i++) {
+        unsigned int offset = string_offsets[i];
+        if (offset < header.text_size && lengths[i] >= 0 &&
+            (unsigned int)lengths[i] < header.text_size - offset && text[offset + lengths[i]] == '\0') {
+            strings[i] = (char *)text + offset;
+        } else {
+            valid = 0;
+        }
+    }
+
+    StringTable *literals = valid ? create_string_view(strings, (int *)lengths, (int)header.string_count) : NULL;
+    IRCode *code = literals ? malloc(sizeof(IRCode)) : NULL;
+    if (!code) {
+        spade_printf(valid ? "Error: Out of memory while loading image <%s>\n"
+                           : "Error: Image <%s> is truncated or corrupt\n", path);
+        if (literals) {
+            free_string_table(literals);
+        } else {
+            free(strings);
+        }
+        free(slot_names);
+        close_source(&image);
+        return NULL;
+    }
+
+    // The image is mapped read-only, so nothing may write through these pointers
+    code->instructions = NULL;
+    code->count = 0;
+    code->capacity = 0;
+    code->bytecode = (unsigned char *)(base + header.bytecode_offset);
+    code->bytecode_size = (int)header.bytecode_size;
+    code->verified_depth = -1;
+    code->slot_names = slot_names;
+    code->slot_is_string = (unsigned char *)(base + header.slot_flags_offset);
+    code->slot_count = (int)header.slot_count;
+    code->slot_capacity = code->slot_count;
+    code->strings = literals;
+    code->image = image;
+    code->source_size = header.source_size;
+    memcpy(&code->source_digest, header.source_digest, sizeof(code->source_digest));
+    return code;
+}
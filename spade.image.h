@@ -0,0 +1,74 @@
+#ifndef SPADE_IMAGE_H
+#define SPADE_IMAGE_H
+
+#include "spade.ir.h"
+
+/**
+ * Compiled program images (.spc files).
+ *
+ * An image holds everything execute_ir_code needs from an IRCode, laid out
+ * so the file can be executed in place once it is memory-mapped: the code
+ * section is the packed bytecode the VM runs (see spade.bytecode.h), and
+ * every name and string literal is an offset into a text section of
+ * NUL-terminated strings. Nothing in the file is a pointer, so loading needs
+ * no per-instruction decoding or fixups and copies no text, and processes
+ * running the same image share one read-only page-cache copy of it.
+ *
+ * The price is that the tables are in the byte order of the host that wrote
+ * them; a mismatch is detected from the header and reported as needing a
+ * recompile.
+ *
+ * Layout (every section starts at a multiple of SPADE_IMAGE_ALIGNMENT):
+ *
+ *   ImageHeader
+ *   unsigned char  bytecode[bytecode_size]
+ *   int            string_lengths[string_count]
+ *   unsigned int   string_offsets[string_count]   into the text section
+ *   unsigned int   slot_name_offsets[slot_count]  into the text section, or SPADE_IMAGE_NO_NAME
+ *   unsigned char  slot_is_string[slot_count]
+ *   char           text[text_size]
+ *
+ * The header also records the size and a digest of the source the image was
+ * compiled from, so the compilation cache can confirm a hit really is the
+ * source it was looked up for; both are 0 in images written by `spade
+ * compile`.
+ *
+ * SPADE_IMAGE_VERSION must be bumped whenever IROpcode, the bytecode encoding
+ * or this layout changes.
+ */
+
+#define SPADE_IMAGE_MAGIC "SPDC"
+#define SPADE_IMAGE_VERSION 5
+#define SPADE_IMAGE_EXTENSION ".spc"
+#define SPADE_IMAGE_BYTE_ORDER 0x01020304u  // Reads back differently on a host of the other byte order
+#define SPADE_IMAGE_ALIGNMENT 16
+#define SPADE_IMAGE_NO_NAME 0xFFFFFFFFu      // Slot name offset of a slot without a name
+
+/**
+ * Fixed header at the start of every image. Offsets are from the start of the file.
+ */
+typedef struct {
+    char magic[4];                  // SPADE_IMAGE_MAGIC
+    unsigned int version;           // SPADE_IMAGE_VERSION
+    unsigned int byte_order;        // SPADE_IMAGE_BYTE_ORDER as written by the producing host
+
+    unsigned int bytecode_size;
+    unsigned int string_count;
+    unsigned int slot_count;
+    unsigned int text_size;
+
+    unsigned int bytecode_offset;
+    unsigned int string_lengths_offset;
+    unsigned int string_offsets_offset;
+    unsigned int slot_names_offset;
+    unsigned int slot_flags_offset;
+    unsigned int text_offset;
+
+    unsigned int source_size;       // IRCode.source_size
+    unsigned int source_digest[2];  // IRCode.source_digest, in host byte order
+} ImageHeader;
+
+int save_ir_image(IRCode *code, const char *path);
+IRCode *load_ir_image(const char *path);
+
+#endif
@@ -2,44 +2,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include "spade.ir.h"
+#include "spade.bytecode.h"
 #include "spade.vm.h"
 #include "spade.symbol.h"
-
-/**
- * Helper function to determine if an AST node represents a string type
- * @param ast The AST node to check
- * @param symbol_table The symbol table to look up variable types
- * @return 1 if the node represents a string, 0 otherwise
- */
-int is_string_type(ASTNode *ast, SymbolTable *symbol_table) {
-    if (!ast) return 0;
-    
-    switch (ast->type) {
-        case AST_STRING_LITERAL:
-            return 1;
-            
-        case AST_IDENTIFIER: {
-            // Look up the variable in the symbol table
-            for (int i = 0; i < symbol_table->count; i++) {
-                if (strcmp(symbol_table->symbols[i]->name, ast->data.identifier.name) == 0) {
-                    return symbol_table->symbols[i]->type == TOKEN_STRING;
-                }
-            }
-            return 0;  // Variable not found, assume not string
-        }
-        
-        case AST_BINARY_OPERATION:
-            // If it's a + operation between strings, the result is a string
-            if (ast->data.bin_op.op == TOKEN_PLUS) {
-                return is_string_type(ast->data.bin_op.left, symbol_table) || 
-                       is_string_type(ast->data.bin_op.right, symbol_table);
-            }
-            return 0;
-            
-        default:
-            return 0;
-    }
-}
+#include "spade.output.h"
 
 /**
  * Creates and initializes a new IR code container.
@@ -54,6 +20,19 @@ IRCode *create_ir_code(void) {
     code->capacity = 100;
     code->count = 0;
     code->instructions = malloc(sizeof(IRInstruction) * code->capacity);
+    code->slot_capacity = 10;
+    code->slot_count = 0;
+    code->slot_names = calloc(code->slot_capacity, sizeof(char *));
+    code->slot_is_string = calloc(code->slot_capacity, sizeof(unsigned char));
+    code->strings = create_string_table();
+    code->bytecode = NULL;
+    code->bytecode_size = 0;
+    code->verified_depth = -1;
+    code->image.data = NULL;
+    code->image.size = 0;
+    code->image.mapped = 0;
+    code->source_size = 0;
+    code->source_digest = 0;
     return code;
 }
 
@@ -100,16 +79,17 @@ void emit_instruction_int(IRCode *code, IROpcode opcode, int value) {
 }
 
 /**
- * Emits an IR instruction with a variable name operand.
+ * Emits an IR instruction with a variable slot operand.
  * 
- * Adds an instruction with a variable name to the IR code sequence.
- * The variable name is duplicated and stored in the instruction.
+ * Adds an instruction that reads or writes a variable through the slot
+ * index resolved by resolve_variable_slot(), so the VM never has to look
+ * variables up by name.
  * 
  * @param code The IR code container to add the instruction to
  * @param opcode The instruction opcode (e.g., IR_PUSH_VAR, IR_STORE_VAR)
- * @param var_name The variable name to associate with the instruction
+ * @param slot The variable slot to associate with the instruction
  */
-void emit_instruction_var(IRCode *code, IROpcode opcode, const char *var_name) {
+void emit_instruction_slot(IRCode *code, IROpcode opcode, int slot) {
     if (code->count >= code->capacity) {
         code->capacity *= 2;
         code->instructions = realloc(code->instructions, 
@@ -117,22 +97,22 @@ void emit_instruction_var(IRCode *code, IROpcode opcode, const char *var_name) {
     }
     
     code->instructions[code->count].opcode = opcode;
-    code->instructions[code->count].operand.var_name = strdup(var_name);
+    code->instructions[code->count].operand.slot = slot;
     code->count++;
 }
 
 /**
  * Emits an IR instruction with a string literal operand.
  * 
- * Adds an instruction with a string literal to the IR code sequence.
- * The string literal is duplicated and stored in the instruction for
- * later processing by the virtual machine.
+ * The literal is interned in the IR code's string table and the instruction
+ * refers to it by index, so identical literals share a single entry.
  * 
  * @param code The IR code container to add the instruction to
  * @param opcode The instruction opcode (e.g., IR_PUSH_STRING_LIT)
  * @param string_lit The string literal to associate with the instruction
+ * @param length Length of the literal in bytes
  */
-void emit_instruction_string_lit(IRCode *code, IROpcode opcode, const char *string_lit) {
+void emit_instruction_string_lit(IRCode *code, IROpcode opcode, const char *string_lit, int length) {
     if (code->count >= code->capacity) {
         code->capacity *= 2;
         code->instructions = realloc(code->instructions,
@@ -140,164 +120,522 @@ void emit_instruction_string_lit(IRCode *code, IROpcode opcode, const char *stri
     }
 
     code->instructions[code->count].opcode = opcode;
-    code->instructions[code->count].operand.string_lit = strdup(string_lit);
+    code->instructions[code->count].operand.int_value = intern_string_length(code->strings, string_lit, length);
     code->count++;
 }
 
 
 /**
- * Recursively generates IR code from an Abstract Syntax Tree.
+ * Emits a jump instruction.
+ *
+ * Forward jumps are emitted before their target is known: pass the head of
+ * a patch chain as the target (-1 for an empty chain) and keep the returned
+ * index as the new head. Each unresolved jump's target links to the
+ * previous one until patch_jumps resolves the whole chain.
+ *
+ * @param code The IR code container to add the instruction to
+ * @param opcode IR_JUMP, IR_JUMP_IF_FALSE or IR_JUMP_IF_TRUE
+ * @param target Index of the instruction to jump to, or the patch chain to link into
+ * @return The index of the new instruction
+ */
+int emit_jump(IRCode *code, IROpcode opcode, int target) {
+    if (code->count >= code->capacity) {
+        code->capacity *= 2;
+        code->instructions = realloc(code->instructions,
+                                   sizeof(IRInstruction) * code->capacity);
+    }
+
+    code->instructions[code->count].opcode = opcode;
+    code->instructions[code->count].operand.target = target;
+    return code->count++;
+}
+
+/**
+ * Resolves every jump in a patch chain built by emit_jump.
+ *
+ * @param code The IR code holding the jumps
+ * @param chain Index of the most recent unresolved jump, or -1
+ * @param target Index of the instruction the jumps continue at
+ */
+void patch_jumps(IRCode *code, int chain, int target) {
+    while (chain >= 0) {
+        int next = code->instructions[chain].operand.target;
+        code->instructions[chain].operand.target = target;
+        chain = next;
+    }
+}
+
+/**
+ * Tells whether an opcode is a jump (its operand is a target).
+ *
+ * @param opcode The instruction opcode
+ * @return 1 for IR_JUMP, IR_JUMP_IF_FALSE and IR_JUMP_IF_TRUE, 0 otherwise
+ */
+int ir_is_jump(IROpcode opcode) {
+    return opcode == IR_JUMP || opcode == IR_JUMP_IF_FALSE || opcode == IR_JUMP_IF_TRUE;
+}
+
+/**
+ * Describes how an instruction changes the VM stack.
  * 
- * Performs post-order traversal of the AST to generate stack-based
- * IR instructions. For expressions, operands are generated before
- * operators to maintain proper stack ordering.
+ * Used by the bytecode verifier and the optimizer to reason about stack
+ * depth without executing the code.
  * 
- * @param ast The AST node to generate IR code for
- * @param code The IR code container to emit instructions to
- * @param vm The virtual machine for string pool management
+ * @param opcode The instruction opcode
+ * @param pops Receives the number of values the instruction pops
+ * @param pushes Receives the number of values the instruction pushes
  */
-void generate_ir(ASTNode *ast, IRCode *code, SymbolTable *symbol_table) {
-    if (!ast) return;
-    
-    switch (ast->type) {
-        case AST_PROGRAM: {
-            // Generate IR for all statements in the program
-            for(int i = 0; i < ast->data.program.statement_count; i++){
-                generate_ir(ast->data.program.statements[i], code, symbol_table);
-            }
+void ir_stack_effect(IROpcode opcode, int *pops, int *pushes) {
+    switch (opcode) {
+        case IR_PUSH_CONST:
+        case IR_PUSH_VAR:
+        case IR_PUSH_STRING_LIT:
+        case IR_ADD_VAR_CONST:
+        case IR_EQ_VAR_VAR:
+        case IR_NE_VAR_VAR:
+        case IR_LT_VAR_VAR:
+        case IR_LE_VAR_VAR:
+            *pops = 0; *pushes = 1;
             break;
-        }
-        
-        case AST_NUMBER:
-            emit_instruction_int(code, IR_PUSH_CONST, ast->data.number.value);
+
+        case IR_STORE_VAR:
+        case IR_JUMP_IF_FALSE:
+        case IR_JUMP_IF_TRUE:
+            *pops = 1; *pushes = 0;
             break;
-            
-        case AST_IDENTIFIER:
-            emit_instruction_var(code, IR_PUSH_VAR, ast->data.identifier.name);
+
+        case IR_INC_VAR:
+        case IR_JUMP:
+        case IR_HALT:
+            *pops = 0; *pushes = 0;
             break;
-            
-        case AST_BOOLEAN:
-            emit_instruction_int(code, IR_PUSH_CONST, ast->data.boolean.value);
+
+        case IR_NOT:
+        case IR_NEG:
+            *pops = 1; *pushes = 1;
             break;
-            
-        case AST_BINARY_OPERATION:
-            // Generate IR for left operand first
-            generate_ir(ast->data.bin_op.left, code, symbol_table);
-            // Generate IR for right operand second
-            generate_ir(ast->data.bin_op.right, code, symbol_table);
-            
-            // Then emit the operation
-            switch (ast->data.bin_op.op) {
-                case TOKEN_PLUS:{
-                    // Check if either operand is a string type
-                    int left_is_string = is_string_type(ast->data.bin_op.left, symbol_table);
-                    int right_is_string = is_string_type(ast->data.bin_op.right, symbol_table);
-                    
-                    // If either operand is a string, treat as string concatenation
-                    if (left_is_string || right_is_string) {
-                        emit_instruction(code, IR_CONCAT);
-                    } else {
-                        // Both operands are non-string types, use regular addition
-                        emit_instruction(code, IR_ADD);
-                    }
+
+        default:
+            // Binary operators: CONCAT, arithmetic, comparison and logical
+            *pops = 2; *pushes = 1;
+            break;
+    }
+}
+
+/**
+ * Resolves a variable name to its VM slot index.
+ *
+ * @param code The IR code container that records slot names and the slot count
+ * @param symbol_table The symbol table used to look up the variable
+ * @param name The variable name to resolve
+ * @return The slot index of the variable, or -1 if the variable is undeclared
+ */
+int resolve_variable_slot(IRCode *code, SymbolTable *symbol_table, const char *name) {
+    Symbol *symbol = lookup_symbol_table(symbol_table, name);
+    if (!symbol) {
+        spade_printf("Error: Undeclared variable '%s' in IR generation\n", name);
+        return -1;
+    }
+    return resolve_symbol_slot(code, symbol_table, symbol);
+}
+
+/**
+ * Resolves an already looked-up variable symbol to its VM slot index.
+ * 
+ * The first time a symbol is seen it is handed the next dense slot index
+ * from the global scope, so every variable maps to a fixed position in the
+ * VM's slot array. The slot name is recorded in the IR code for debugging
+ * output, and whether it holds a string so the VM can find live strings.
+ * 
+ * @param code The IR code container that records slot names and the slot count
+ * @param symbol_table The scope the symbol was found from (its global scope counts the slots)
+ * @param symbol The variable's symbol
+ * @return The slot index of the variable
+ */
+int resolve_symbol_slot(IRCode *code, SymbolTable *symbol_table, Symbol *symbol) {
+    if (symbol->slot < 0) {
+        // Slots are numbered across the whole program, so count them on the global scope
+        SymbolTable *global_scope = symbol_table;
+        while (global_scope->parent != NULL) {
+            global_scope = global_scope->parent;
+        }
+        symbol->slot = global_scope->slot_count++;
+    }
+
+    if (symbol->slot >= code->slot_capacity) {
+        int old_capacity = code->slot_capacity;
+        while (symbol->slot >= code->slot_capacity) {
+            code->slot_capacity *= 2;
+        }
+        code->slot_names = realloc(code->slot_names, sizeof(char *) * code->slot_capacity);
+        memset(code->slot_names + old_capacity, 0, sizeof(char *) * (code->slot_capacity - old_capacity));
+        code->slot_is_string = realloc(code->slot_is_string, code->slot_capacity);
+        memset(code->slot_is_string + old_capacity, 0, code->slot_capacity - old_capacity);
+    }
+
+    if (code->slot_names[symbol->slot] == NULL) {
+        code->slot_names[symbol->slot] = strdup(symbol->name);
+        code->slot_is_string[symbol->slot] = symbol->type == TOKEN_STRING;
+    }
+
+    if (symbol->slot >= code->slot_count) {
+        code->slot_count = symbol->slot + 1;
+    }
+
+    return symbol->slot;
+}
+
+/**
+ * Generates IR code for one expression of a flat AST.
+ *
+ * The expression's nodes are already in post-order, so a single forward scan
+ * emits operands before their operators. Identifiers use the symbol semantic
+ * analysis annotated them with, and PLUS and EQ/NE pick their string variants
+ * from the operands' annotated types.
+ *
+ * Nodes semantic analysis left untyped (type errors, or statements it
+ * rejected before reaching the expression) fall back to the structural rule:
+ * literals and string variables are strings, and so is a + with a string
+ * operand.
+ *
+ * @param ast The flat AST holding the expression
+ * @param range The expression's node range
+ * @param is_string Per-node scratch array, indexed like ast->kinds
+ * @param code The IR code container to emit instructions to
+ * @param symbol_table The symbol table used to resolve variables
+ */
+void generate_expression_ir(FlatAST *ast, FlatRange range, unsigned char *is_string,
+                            IRCode *code, SymbolTable *symbol_table) {
+    for (int i = range.start; i <= range.root; i++) {
+        is_string[i] = ast->types[i] == TOKEN_STRING;
+
+        switch (ast->kinds[i]) {
+            case AST_NUMBER:
+            case AST_BOOLEAN:
+                emit_instruction_int(code, IR_PUSH_CONST, ast->values[i]);
+                break;
+
+            case AST_IDENTIFIER: {
+                const char *name = ast->names[ast->values[i]];
+                Symbol *symbol = ast->symbols[i] ? ast->symbols[i] : lookup_symbol_table(symbol_table, name);
+                if (!symbol) {
+                    emit_instruction_slot(code, IR_PUSH_VAR, resolve_variable_slot(code, symbol_table, name));
                     break;
-                }     
-                case TOKEN_MINUS:    emit_instruction(code, IR_SUB); break;
-                case TOKEN_MULTIPLY: emit_instruction(code, IR_MUL); break;
-                case TOKEN_DIVIDE:   emit_instruction(code, IR_DIV); break;
-                case TOKEN_MODULO:   emit_instruction(code, IR_MOD); break;
-                case TOKEN_POWER:    emit_instruction(code, IR_POW); break;
-                case TOKEN_EQUALS:   emit_instruction(code, IR_EQ); break;
-                case TOKEN_NOT_EQUALS: emit_instruction(code, IR_NE); break;
-                case TOKEN_LESS_THAN: emit_instruction(code, IR_LT); break;
-                case TOKEN_GREATER_THAN: emit_instruction(code, IR_GT); break;
-                case TOKEN_LESS_THAN_EQUALS: emit_instruction(code, IR_LE); break;
-                case TOKEN_GREATER_THAN_EQUALS: emit_instruction(code, IR_GE); break;
-                case TOKEN_AND:      emit_instruction(code, IR_AND); break;
-                case TOKEN_OR:       emit_instruction(code, IR_OR); break;
-                default:
-                    printf("Unknown binary operator in IR generation\n");
+                }
+                is_string[i] = symbol->type == TOKEN_STRING;
+                emit_instruction_slot(code, IR_PUSH_VAR, resolve_symbol_slot(code, symbol_table, symbol));
+                break;
             }
-            break;
-            
-        case AST_VARIABLE_DECLARATION:
-            // Generate IR for the initializer expression if present
-            if (ast->data.var_declaration.value) {
-                generate_ir(ast->data.var_declaration.value, code, symbol_table);
-                emit_instruction_var(code, IR_STORE_VAR, ast->data.var_declaration.name);
+
+            case AST_STRING_LITERAL: {
+                // Add string to pool and emit index
+                FlatString *literal = &ast->strings[ast->values[i]];
+                emit_instruction_string_lit(code, IR_PUSH_STRING_LIT, literal->value, literal->length);
+                is_string[i] = 1;
+                break;
             }
-            break;
 
-        case AST_ASSIGNMENT: {
-            // look up the variable in the symbol table
-            Symbol *symbol = lookup_symbol_table(symbol_table, ast->data.variable_assignment.name);
-            if(symbol){
-                if(ast->data.variable_assignment.value){
-                    generate_ir(ast->data.variable_assignment.value, code, symbol_table);
-                    emit_instruction_var(code, IR_STORE_VAR, symbol->name);
+            case AST_BINARY_OPERATION: {
+                // Operands were emitted by the iterations that visited them
+                int left_is_string = ast->lefts[i] >= 0 && is_string[ast->lefts[i]];
+                int right_is_string = ast->rights[i] >= 0 && is_string[ast->rights[i]];
+
+                switch (ast->values[i]) {
+                    case TOKEN_PLUS:
+                        // If either operand is a string, treat as string concatenation
+                        if (left_is_string || right_is_string) {
+                            emit_instruction(code, IR_CONCAT);
+                            is_string[i] = 1;  // Also covers an ill-typed mix like "a" + 1
+                        } else {
+                            // Both operands are non-string types, use regular addition
+                            emit_instruction(code, IR_ADD);
+                        }
+                        break;
+                    case TOKEN_MINUS:    emit_instruction(code, IR_SUB); break;
+                    case TOKEN_MULTIPLY: emit_instruction(code, IR_MUL); break;
+                    case TOKEN_DIVIDE:   emit_instruction(code, IR_DIV); break;
+                    case TOKEN_MODULO:   emit_instruction(code, IR_MOD); break;
+                    case TOKEN_POWER:    emit_instruction(code, IR_POW); break;
+                    case TOKEN_EQUALS:
+                    case TOKEN_NOT_EQUALS: {
+                        // Strings are compared by contents, which may need a rope flattened first
+                        int is_equals = ast->values[i] == TOKEN_EQUALS;
+                        if (left_is_string || right_is_string) {
+                            emit_instruction(code, is_equals ? IR_STR_EQ : IR_STR_NE);
+                        } else {
+                            emit_instruction(code, is_equals ? IR_EQ : IR_NE);
+                        }
+                        break;
+                    }
+                    case TOKEN_LESS_THAN: emit_instruction(code, IR_LT); break;
+                    case TOKEN_GREATER_THAN: emit_instruction(code, IR_GT); break;
+                    case TOKEN_LESS_THAN_EQUALS: emit_instruction(code, IR_LE); break;
+                    case TOKEN_GREATER_THAN_EQUALS: emit_instruction(code, IR_GE); break;
+                    case TOKEN_AND:      emit_instruction(code, IR_AND); break;
+                    case TOKEN_OR:       emit_instruction(code, IR_OR); break;
+                    default:
+                        spade_printf("Unknown binary operator in IR generation\n");
                 }
+                break;
             }
-            break;
+
+            case AST_UNARY_OPERATION:
+                switch (ast->values[i]) {
+                    case TOKEN_MINUS: emit_instruction(code, IR_NEG); break;
+                    case TOKEN_NOT:   emit_instruction(code, IR_NOT); break;
+                    default:
+                        spade_printf("Unknown unary operator in IR generation\n");
+                }
+                break;
+
+            case AST_FUNCTION_CALL:
+                // Calls are not compiled yet; skip the call together with its arguments
+                spade_printf("Unknown AST node type in IR generation\n");
+                i = ast->calls[ast->values[i]].end - 1;
+                break;
+
+            default:
+                spade_printf("Unknown AST node type in IR generation\n");
         }
-            
-        case AST_UNARY_OPERATION:
-            generate_ir(ast->data.unary_op.operand, code, symbol_table);
-            switch (ast->data.unary_op.op) {
-                case TOKEN_MINUS: emit_instruction(code, IR_NEG); break;
-                case TOKEN_NOT:   emit_instruction(code, IR_NOT); break;
-                default:
-                    printf("Unknown unary operator in IR generation\n");
+    }
+}
+
+/**
+ * Jumps waiting for the targets of the innermost enclosing loop.
+ *
+ * @param breaks Patch chain of the loop's break jumps (-1 when empty)
+ * @param continues Patch chain of the loop's continue jumps (-1 when empty)
+ */
+typedef struct {
+    int breaks;
+    int continues;
+} IRLoop;
+
+/**
+ * Generates IR code for a range of statements that share a scope.
+ *
+ * Statements are visited in program order; each one's expression is emitted
+ * by a linear scan of its node range before the instruction that consumes
+ * it. Statements nested in a block, if or loop are generated by a recursive
+ * call over their range.
+ *
+ * Every statement starts and ends with an empty stack, so all jumps (which
+ * only happen between statements) leave the stack empty. Loops are laid out
+ * with the condition at the bottom, so an iteration costs one conditional
+ * jump:
+ *
+ *         JUMP cond            (omitted without a condition)
+ *   body: <body>
+ *   next: <update>             (for loops; continue jumps here)
+ *   cond: <condition>
+ *         JUMP_IF_TRUE body    (JUMP body without a condition)
+ *                              (break jumps here)
+ *
+ * @param ast The flat AST of the program
+ * @param first Index of the first statement to generate
+ * @param end Index just past the last statement to generate
+ * @param loop The innermost enclosing loop, or NULL outside loops
+ * @param is_string Per-node scratch array, indexed like ast->kinds
+ * @param code The IR code container to emit instructions to
+ * @param symbol_table The scope the statements are declared in
+ */
+void generate_statements_ir(FlatAST *ast, int first, int end, IRLoop *loop, unsigned char *is_string,
+                            IRCode *code, SymbolTable *symbol_table) {
+    for (int s = first; s < end; s = ast->statements[s].end) {
+        FlatStatement *statement = &ast->statements[s];
+
+        switch (statement->kind) {
+            case AST_VARIABLE_DECLARATION: {
+                // An unbraced if or loop body declares into a scope of its own
+                SymbolTable *scope = statement->scope ? statement->scope : symbol_table;
+
+                // Every declared variable gets a slot, even without an initializer
+                int slot = resolve_variable_slot(code, scope, statement->name);
+
+                // Without an initializer the variable starts out as 0, false or "", and is
+                // reset every time the declaration runs (each iteration of a loop body)
+                if (statement->expression.start >= 0) {
+                    generate_expression_ir(ast, statement->expression, is_string, code, scope);
+                } else if (statement->type == TOKEN_STRING) {
+                    emit_instruction_string_lit(code, IR_PUSH_STRING_LIT, "", 0);
+                } else {
+                    emit_instruction_int(code, IR_PUSH_CONST, 0);
+                }
+                emit_instruction_slot(code, IR_STORE_VAR, slot);
+                break;
             }
-            break;
 
-        case AST_STRING_LITERAL: {
-            // Add string to pool and emit index
-            emit_instruction_string_lit(code, IR_PUSH_STRING_LIT, ast->data.string_lit.value);
-            break;
+            case AST_ASSIGNMENT: {
+                // look up the variable in the symbol table
+                Symbol *symbol = lookup_symbol_table(symbol_table, statement->name);
+                if (symbol && statement->expression.start >= 0) {
+                    generate_expression_ir(ast, statement->expression, is_string, code, symbol_table);
+                    emit_instruction_slot(code, IR_STORE_VAR,
+                                          resolve_symbol_slot(code, symbol_table, symbol));
+                }
+                break;
+            }
+
+            case AST_BLOCK:
+                // Use the scope semantic analysis declared the block's variables in
+                generate_statements_ir(ast, s + 1, statement->end, loop, is_string, code,
+                                       statement->scope ? statement->scope : symbol_table);
+                break;
+
+            case AST_IF: {
+                generate_expression_ir(ast, statement->expression, is_string, code, symbol_table);
+                int skip_then = emit_jump(code, IR_JUMP_IF_FALSE, -1);
+                generate_statements_ir(ast, s + 1, statement->alternative, loop, is_string, code, symbol_table);
+
+                if (statement->alternative < statement->end) {
+                    int skip_else = emit_jump(code, IR_JUMP, -1);
+                    patch_jumps(code, skip_then, code->count);
+                    generate_statements_ir(ast, statement->alternative, statement->end, loop, is_string, code, symbol_table);
+                    patch_jumps(code, skip_else, code->count);
+                } else {
+                    patch_jumps(code, skip_then, code->count);
+                }
+                break;
+            }
+
+            case AST_WHILE:
+            case AST_FOR: {
+                int has_condition = statement->expression.start >= 0;
+                int to_condition = has_condition ? emit_jump(code, IR_JUMP, -1) : -1;
+                IRLoop inner = { -1, -1 };
+
+                int body = code->count;
+                generate_statements_ir(ast, s + 1, statement->alternative, &inner, is_string, code, symbol_table);
+
+                // A while loop's update range is empty, so continue goes straight to the condition
+                patch_jumps(code, inner.continues, code->count);
+                generate_statements_ir(ast, statement->alternative, statement->end, &inner, is_string, code, symbol_table);
+
+                patch_jumps(code, to_condition, code->count);
+                if (has_condition) {
+                    generate_expression_ir(ast, statement->expression, is_string, code, symbol_table);
+                    emit_jump(code, IR_JUMP_IF_TRUE, body);
+                } else {
+                    emit_jump(code, IR_JUMP, body);
+                }
+                patch_jumps(code, inner.breaks, code->count);
+                break;
+            }
+
+            case AST_BREAK:
+            case AST_CONTINUE:
+                // Outside a loop semantic analysis has already reported it; emit nothing
+                if (!loop) break;
+                if (statement->kind == AST_BREAK) {
+                    loop->breaks = emit_jump(code, IR_JUMP, loop->breaks);
+                } else {
+                    loop->continues = emit_jump(code, IR_JUMP, loop->continues);
+                }
+                break;
+
+            default:
+                spade_printf("Unknown AST node type in IR generation\n");
         }
-            
-        default:
-            printf("Unknown AST node type in IR generation\n");
     }
 }
 
+/**
+ * Generates IR code for a flattened program.
+ *
+ * @param ast The flat AST of the program
+ * @param code The IR code container to emit instructions to
+ * @param symbol_table The symbol table used to resolve variables
+ */
+void generate_ir(FlatAST *ast, IRCode *code, SymbolTable *symbol_table) {
+    if (!ast) return;
+
+    unsigned char *is_string = malloc(ast->count ? ast->count : 1);
+    generate_statements_ir(ast, 0, ast->statement_count, NULL, is_string, code, symbol_table);
+    free(is_string);
+}
+
+/**
+ * Returns the variable name recorded for a slot, for debugging output.
+ * 
+ * @param code The IR code container holding the slot names
+ * @param slot The slot index to name
+ * @return The variable name, or "<unresolved>" if the slot has no name
+ */
+const char *ir_slot_name(IRCode *code, int slot) {
+    if (slot < 0 || slot >= code->slot_count || code->slot_names[slot] == NULL) {
+        return "<unresolved>";
+    }
+    return code->slot_names[slot];
+}
+
 /**
  * Prints the IR code instructions to the console for debugging.
  * 
  * Displays each instruction with its index, opcode, and operands
- * in a human-readable format.
+ * in a human-readable format. Code loaded from an image is unpacked from
+ * its bytecode first.
  * 
  * @param code The IR code container to print
  */
 void print_ir_code(IRCode *code) {
-    printf("\n=== IR CODE ===\n");
+    spade_printf("\n=== IR CODE ===\n");
+    if (!code->instructions && !unpack_ir_code(code)) {
+        spade_printf("Error: Malformed bytecode\n");
+        return;
+    }
     for (int i = 0; i < code->count; i++) {
         IRInstruction *instr = &code->instructions[i];
-        printf("%3d: ", i);
+        spade_printf("%3d: ", i);
         
         switch (instr->opcode) {
-            case IR_PUSH_CONST: printf("PUSH_CONST %d\n", instr->operand.int_value); break;
-            case IR_PUSH_VAR:   printf("PUSH_VAR %s\n", instr->operand.var_name); break;
-            case IR_PUSH_STRING_LIT: printf("PUSH_STRING_LIT \"%s\"\n", instr->operand.string_lit); break;
-            case IR_STORE_VAR:  printf("STORE_VAR %s\n", instr->operand.var_name); break;
-            case IR_CONCAT:     printf("CONCAT\n"); break;
-            case IR_ADD:        printf("ADD\n"); break;
-            case IR_SUB:        printf("SUB\n"); break;
-            case IR_MUL:        printf("MUL\n"); break;
-            case IR_DIV:        printf("DIV\n"); break;
-            case IR_MOD:        printf("MOD\n"); break;
-            case IR_POW:        printf("POW\n"); break;
-            case IR_EQ:         printf("EQ\n"); break;
-            case IR_NE:         printf("NE\n"); break;
-            case IR_LT:         printf("LT\n"); break;
-            case IR_GT:         printf("GT\n"); break;
-            case IR_LE:         printf("LE\n"); break;
-            case IR_GE:         printf("GE\n"); break;
-            case IR_AND:        printf("AND\n"); break;
-            case IR_OR:         printf("OR\n"); break;
-            case IR_NOT:        printf("NOT\n"); break;
-            case IR_NEG:        printf("NEG\n"); break;
-            case IR_HALT:       printf("HALT\n"); break;
+            case IR_PUSH_CONST: spade_printf("PUSH_CONST %d\n", instr->operand.int_value); break;
+            case IR_PUSH_VAR:   spade_printf("PUSH_VAR %s (slot %d)\n", ir_slot_name(code, instr->operand.slot), instr->operand.slot); break;
+            case IR_PUSH_STRING_LIT:
+                spade_printf("PUSH_STRING_LIT \"");
+                fwrite(string_table_get(code->strings, instr->operand.int_value), 1,
+                       string_table_length(code->strings, instr->operand.int_value), spade_stdout());
+                spade_printf("\"\n");
+                break;
+            case IR_STORE_VAR:  spade_printf("STORE_VAR %s (slot %d)\n", ir_slot_name(code, instr->operand.slot), instr->operand.slot); break;
+            case IR_CONCAT:     spade_printf("CONCAT\n"); break;
+            case IR_ADD:        spade_printf("ADD\n"); break;
+            case IR_SUB:        spade_printf("SUB\n"); break;
+            case IR_MUL:        spade_printf("MUL\n"); break;
+            case IR_DIV:        spade_printf("DIV\n"); break;
+            case IR_MOD:        spade_printf("MOD\n"); break;
+            case IR_POW:        spade_printf("POW\n"); break;
+            case IR_EQ:         spade_printf("EQ\n"); break;
+            case IR_NE:         spade_printf("NE\n"); break;
+            case IR_LT:         spade_printf("LT\n"); break;
+            case IR_GT:         spade_printf("GT\n"); break;
+            case IR_LE:         spade_printf("LE\n"); break;
+            case IR_GE:         spade_printf("GE\n"); break;
+            case IR_AND:        spade_printf("AND\n"); break;
+            case IR_OR:         spade_printf("OR\n"); break;
+            case IR_NOT:        spade_printf("NOT\n"); break;
+            case IR_NEG:        spade_printf("NEG\n"); break;
+            case IR_STR_EQ:     spade_printf("STR_EQ\n"); break;
+            case IR_STR_NE:     spade_printf("STR_NE\n"); break;
+            case IR_ADD_VAR_CONST:
+            case IR_INC_VAR:
+                spade_printf("%s %s (slot %d), %d\n", instr->opcode == IR_INC_VAR ? "INC_VAR" : "ADD_VAR_CONST",
+                       ir_slot_name(code, instr->operand.var_const.slot), instr->operand.var_const.slot,
+                       instr->operand.var_const.value);
+                break;
+            case IR_EQ_VAR_VAR:
+            case IR_NE_VAR_VAR:
+            case IR_LT_VAR_VAR:
+            case IR_LE_VAR_VAR: {
+                static const char *names[] = { "EQ_VAR_VAR", "NE_VAR_VAR", "LT_VAR_VAR", "LE_VAR_VAR" };
+                spade_printf("%s %s (slot %d), %s (slot %d)\n", names[instr->opcode - IR_EQ_VAR_VAR],
+                       ir_slot_name(code, instr->operand.var_pair.left), instr->operand.var_pair.left,
+                       ir_slot_name(code, instr->operand.var_pair.right), instr->operand.var_pair.right);
+                break;
+            }
+            case IR_JUMP:          spade_printf("JUMP %d\n", instr->operand.target); break;
+            case IR_JUMP_IF_FALSE: spade_printf("JUMP_IF_FALSE %d\n", instr->operand.target); break;
+            case IR_JUMP_IF_TRUE:  spade_printf("JUMP_IF_TRUE %d\n", instr->operand.target); break;
+            case IR_HALT:       spade_printf("HALT\n"); break;
         }
     }
 }
@@ -305,29 +643,464 @@ void print_ir_code(IRCode *code) {
 /**
  * Frees memory allocated for an IR code container and its instructions.
  * 
- * Releases memory for variable names stored in instructions, the instruction
- * array, and the IRCode structure itself.
+ * Releases memory for the slot names, the string literal table, the
+ * instruction array, and the IRCode structure itself.
  * 
  * @param code The IR code container to be freed
  */
 void free_ir_code(IRCode *code) {
     if(!code) return;
 
-    // Free allocated strings in instructions
-    for(int i = 0; i < code->count; i++){
+    if(code->image.data){
+        // Loaded from an image: only the pointer tables (and any unpacked instructions) were allocated,
+        // the rest is the image itself
+        free(code->instructions);
+        free(code->slot_names);
+        free_string_table(code->strings);
+        close_source(&code->image);
+        free(code);
+        return;
+    }
+
+    // Free slot names
+    for(int i = 0; i < code->slot_capacity; i++){
+        if(code->slot_names[i] != NULL){
+            free(code->slot_names[i]);
+        }
+    }
+    free(code->slot_names);
+    free(code->slot_is_string);
+
+    free_string_table(code->strings);
+    free(code->instructions);
+    free(code->bytecode);
+    free(code);
+}
+
+/**
+ * Appends a three-address instruction to register code.
+ * 
+ * @param code The register code container to add the instruction to
+ * @param opcode The instruction opcode
+ * @param dst The destination register
+ * @param a The first operand register
+ * @param b The second operand register
+ * @return The index of the new instruction
+ */
+int emit_reg_instruction(RegCode *code, RegOpcode opcode, int dst, int a, int b) {
+    if (code->count >= code->capacity) {
+        code->capacity *= 2;
+        code->instructions = realloc(code->instructions,
+                                   sizeof(RegInstruction) * code->capacity);
+    }
+
+    code->instructions[code->count].opcode = opcode;
+    code->instructions[code->count].dst = dst;
+    code->instructions[code->count].a = a;
+    code->instructions[code->count].b = b;
+    return code->count++;
+}
+
+/**
+ * Returns the constant table index for a value, adding it if it is new.
+ * 
+ * @param code The register code container holding the constant table
+ * @param value The constant value
+ * @return The index of the value in the constant table
+ */
+int reg_constant_index(RegCode *code, int value) {
+    for (int i = 0; i < code->constant_count; i++) {
+        if (code->constants[i] == value) {
+            return i;
+        }
+    }
+
+    if (code->constant_count >= code->constant_capacity) {
+        code->constant_capacity *= 2;
+        code->constants = realloc(code->constants, sizeof(int) * code->constant_capacity);
+    }
+    code->constants[code->constant_count] = value;
+    return code->constant_count++;
+}
+
+/**
+ * Maps a stack IR binary/unary opcode to its register equivalent.
+ * 
+ * @param opcode The stack IR opcode
+ * @return The register opcode, or -1 if the opcode is not an operator
+ */
+int reg_opcode_for(IROpcode opcode) {
+    switch (opcode) {
+        case IR_CONCAT: return REG_CONCAT;
+        case IR_ADD:    return REG_ADD;
+        case IR_SUB:    return REG_SUB;
+        case IR_MUL:    return REG_MUL;
+        case IR_DIV:    return REG_DIV;
+        case IR_MOD:    return REG_MOD;
+        case IR_POW:    return REG_POW;
+        case IR_EQ:     return REG_EQ;
+        case IR_NE:     return REG_NE;
+        case IR_LT:     return REG_LT;
+        case IR_GT:     return REG_GT;
+        case IR_LE:     return REG_LE;
+        case IR_GE:     return REG_GE;
+        case IR_AND:    return REG_AND;
+        case IR_OR:     return REG_OR;
+        case IR_NOT:    return REG_NOT;
+        case IR_NEG:    return REG_NEG;
+        case IR_STR_EQ: return REG_STR_EQ;
+        case IR_STR_NE: return REG_STR_NE;
+        default:        return -1;
+    }
+}
+
+/**
+ * Copies stack entries that still read a variable into their own temporaries.
+ * 
+ * Pushed variables are referenced by their slot register instead of being
+ * copied, so before the slot is overwritten every such reference is
+ * materialized to keep seeing the old value.
+ * 
+ * @param reg The register code being built
+ * @param stack Register backing each simulated stack position
+ * @param producer Index of the instruction that computed each position, or -1
+ * @param depth Number of values currently on the simulated stack
+ * @param slot The variable slot about to be written
+ */
+void reg_materialize_slot(RegCode *reg, int *stack, int *producer, int depth, int slot) {
+    int temp_base = reg->slot_count;
+    for (int j = 0; j < depth; j++) {
+        if (stack[j] == slot) {
+            emit_reg_instruction(reg, REG_MOVE, temp_base + j, slot, 0);
+            stack[j] = temp_base + j;
+            producer[j] = -1;
+        }
+    }
+}
+
+/**
+ * Lowers stack-based IR to three-address register code.
+ * 
+ * Simulates the operand stack at compile time: stack position d is backed by
+ * temporary register slot_count + d, while pushed variables and constants are
+ * referenced directly by their registers instead of being copied. An operator
+ * therefore becomes a single instruction reading its operands in place, and a
+ * STORE_VAR that directly follows the instruction computing its value simply
+ * retargets that instruction at the variable's slot.
+ * 
+ * Jumps only happen with an empty stack, so the simulation never has to
+ * merge stacks where control flow joins, and a jump target maps to the first
+ * register instruction lowered from its IR instruction.
+ * 
+ * @param code The stack IR to lower (must end with IR_HALT; unpacked first if it only has bytecode)
+ * @return Newly allocated register code, or NULL if the IR is malformed
+ */
+RegCode *lower_ir_to_reg(IRCode *code) {
+    if (!code->instructions && !unpack_ir_code(code)) {
+        spade_printf("Error: Cannot lower IR, malformed bytecode\n");
+        return NULL;
+    }
+
+    // First pass: the deepest stack decides how many temporaries are needed.
+    // reg_index holds the depth before each instruction until it maps instructions to register code.
+    int *reg_index = malloc(sizeof(int) * (code->count + 1));
+    int depth = 0;
+    int max_depth = 0;
+    for (int i = 0; i < code->count; i++) {
+        int pops, pushes;
+        ir_stack_effect(code->instructions[i].opcode, &pops, &pushes);
+        reg_index[i] = depth;
+        if (depth < pops) {
+            spade_printf("Error: Cannot lower IR, stack underflow at instruction %d\n", i);
+            free(reg_index);
+            return NULL;
+        }
+        depth += pushes - pops;
+        if (depth > max_depth) max_depth = depth;
+        if (ir_is_jump(code->instructions[i].opcode) && depth != 0) {
+            spade_printf("Error: Cannot lower IR, jump with a non-empty stack at instruction %d\n", i);
+            free(reg_index);
+            return NULL;
+        }
+    }
+    for (int i = 0; i < code->count; i++) {
+        int target = code->instructions[i].operand.target;
+        if (ir_is_jump(code->instructions[i].opcode) &&
+            (target < 0 || target >= code->count || reg_index[target] != 0)) {
+            spade_printf("Error: Cannot lower IR, invalid jump target at instruction %d\n", i);
+            free(reg_index);
+            return NULL;
+        }
+    }
+
+    RegCode *reg = malloc(sizeof(RegCode));
+    reg->capacity = code->count > 0 ? code->count : 1;
+    reg->count = 0;
+    reg->instructions = malloc(sizeof(RegInstruction) * reg->capacity);
+    reg->constant_capacity = 16;
+    reg->constant_count = 0;
+    reg->constants = malloc(sizeof(int) * reg->constant_capacity);
+    reg->strings = code->strings;
+    reg->slot_count = code->slot_count;
+    reg->temp_count = max_depth;
+    reg->slot_names = code->slot_names;
+    reg->slot_is_string = code->slot_is_string;
+
+    // Constant k is encoded as operand -(k + 1) until the constant registers are placed at the end
+    int *stack = malloc(sizeof(int) * (max_depth > 0 ? max_depth : 1));
+    int *producer = malloc(sizeof(int) * (max_depth > 0 ? max_depth : 1));
+    int temp_base = reg->slot_count;
+    depth = 0;
+
+    for (int i = 0; i < code->count; i++) {
         IRInstruction *instr = &code->instructions[i];
-        if(instr->opcode == IR_PUSH_VAR || instr->opcode == IR_STORE_VAR){
-            if(instr->operand.var_name != NULL){
-                free(instr->operand.var_name);
+        reg_index[i] = reg->count;
+
+        switch (instr->opcode) {
+            case IR_PUSH_CONST:
+                stack[depth] = -(reg_constant_index(reg, instr->operand.int_value) + 1);
+                producer[depth] = -1;
+                depth++;
+                break;
+
+            case IR_PUSH_VAR:
+                if (instr->operand.slot < 0 || instr->operand.slot >= reg->slot_count) {
+                    spade_printf("Error: Cannot lower IR, unresolved variable slot at instruction %d\n", i);
+                    goto fail;
+                }
+                stack[depth] = instr->operand.slot;
+                producer[depth] = -1;
+                depth++;
+                break;
+
+            case IR_PUSH_STRING_LIT: {
+                int index = emit_reg_instruction(reg, REG_LOAD_STRING, temp_base + depth, instr->operand.int_value, 0);
+                stack[depth] = temp_base + depth;
+                producer[depth] = index;
+                depth++;
+                break;
             }
-        }
-        else if(instr->opcode == IR_PUSH_STRING_LIT){
-            if(instr->operand.string_lit != NULL){
-                free(instr->operand.string_lit);
+
+            case IR_STORE_VAR: {
+                int slot = instr->operand.slot;
+                if (slot < 0 || slot >= reg->slot_count) {
+                    spade_printf("Error: Cannot lower IR, unresolved variable slot at instruction %d\n", i);
+                    goto fail;
+                }
+                depth--;
+                reg_materialize_slot(reg, stack, producer, depth, slot);
+
+                if (producer[depth] >= 0 && producer[depth] == reg->count - 1) {
+                    // The value was computed by the previous instruction, write it straight to the slot
+                    reg->instructions[producer[depth]].dst = slot;
+                } else {
+                    emit_reg_instruction(reg, REG_MOVE, slot, stack[depth], 0);
+                }
+                break;
+            }
+
+            case IR_ADD_VAR_CONST: {
+                int slot = instr->operand.var_const.slot;
+                if (slot < 0 || slot >= reg->slot_count) {
+                    spade_printf("Error: Cannot lower IR, unresolved variable slot at instruction %d\n", i);
+                    goto fail;
+                }
+                int constant = -(reg_constant_index(reg, instr->operand.var_const.value) + 1);
+                int index = emit_reg_instruction(reg, REG_ADD, temp_base + depth, slot, constant);
+                stack[depth] = temp_base + depth;
+                producer[depth] = index;
+                depth++;
+                break;
+            }
+
+            case IR_INC_VAR: {
+                int slot = instr->operand.var_const.slot;
+                if (slot < 0 || slot >= reg->slot_count) {
+                    spade_printf("Error: Cannot lower IR, unresolved variable slot at instruction %d\n", i);
+                    goto fail;
+                }
+                reg_materialize_slot(reg, stack, producer, depth, slot);
+                int constant = -(reg_constant_index(reg, instr->operand.var_const.value) + 1);
+                emit_reg_instruction(reg, REG_ADD, slot, slot, constant);
+                break;
+            }
+
+            case IR_EQ_VAR_VAR:
+            case IR_NE_VAR_VAR:
+            case IR_LT_VAR_VAR:
+            case IR_LE_VAR_VAR: {
+                static const RegOpcode compare[] = { REG_EQ, REG_NE, REG_LT, REG_LE };
+                int left = instr->operand.var_pair.left;
+                int right = instr->operand.var_pair.right;
+                if (left < 0 || left >= reg->slot_count || right < 0 || right >= reg->slot_count) {
+                    spade_printf("Error: Cannot lower IR, unresolved variable slot at instruction %d\n", i);
+                    goto fail;
+                }
+                int index = emit_reg_instruction(reg, compare[instr->opcode - IR_EQ_VAR_VAR],
+                                                 temp_base + depth, left, right);
+                stack[depth] = temp_base + depth;
+                producer[depth] = index;
+                depth++;
+                break;
+            }
+
+            case IR_NOT:
+            case IR_NEG: {
+                int a = depth - 1;
+                int index = emit_reg_instruction(reg, reg_opcode_for(instr->opcode), temp_base + a, stack[a], 0);
+                stack[a] = temp_base + a;
+                producer[a] = index;
+                break;
+            }
+
+            case IR_JUMP:
+                // The target is an IR index until every instruction has been lowered
+                emit_reg_instruction(reg, REG_JUMP, instr->operand.target, 0, 0);
+                break;
+
+            case IR_JUMP_IF_FALSE:
+            case IR_JUMP_IF_TRUE:
+                depth--;
+                emit_reg_instruction(reg, instr->opcode == IR_JUMP_IF_FALSE ? REG_JUMP_IF_FALSE : REG_JUMP_IF_TRUE,
+                                     instr->operand.target, stack[depth], 0);
+                break;
+
+            case IR_HALT:
+                emit_reg_instruction(reg, REG_HALT, 0, 0, 0);
+                break;
+
+            default: {
+                // Binary operators
+                int opcode = reg_opcode_for(instr->opcode);
+                if (opcode < 0) {
+                    spade_printf("Error: Cannot lower IR opcode %d at instruction %d\n", instr->opcode, i);
+                    goto fail;
+                }
+                int a = depth - 2;
+                int b = depth - 1;
+                int index = emit_reg_instruction(reg, opcode, temp_base + a, stack[a], stack[b]);
+                depth--;
+                stack[a] = temp_base + a;
+                producer[a] = index;
+                break;
             }
         }
     }
 
+    // Constant registers live behind the temporaries now that their count is known
+    int constant_base = reg->slot_count + reg->temp_count;
+    for (int i = 0; i < reg->count; i++) {
+        if (reg->instructions[i].a < 0) reg->instructions[i].a = constant_base - reg->instructions[i].a - 1;
+        if (reg->instructions[i].b < 0) reg->instructions[i].b = constant_base - reg->instructions[i].b - 1;
+        if (reg->instructions[i].opcode >= REG_JUMP && reg->instructions[i].opcode <= REG_JUMP_IF_TRUE) {
+            reg->instructions[i].dst = reg_index[reg->instructions[i].dst];
+        }
+    }
+
+    free(stack);
+    free(producer);
+    free(reg_index);
+    return reg;
+
+fail:
+    free(stack);
+    free(producer);
+    free(reg_index);
+    free_reg_code(reg);
+    return NULL;
+}
+
+/**
+ * Formats a register operand for debugging output.
+ * 
+ * Variable slots print as their names, temporaries as tN and constant
+ * registers as #value.
+ * 
+ * @param code The register code the operand belongs to
+ * @param reg The register number
+ * @param buffer Buffer to write the text into
+ * @param size Size of the buffer
+ * @return The buffer
+ */
+const char *format_reg_operand(RegCode *code, int reg, char *buffer, int size) {
+    int constant_base = code->slot_count + code->temp_count;
+    if (reg < code->slot_count) {
+        snprintf(buffer, size, "%s", code->slot_names[reg] ? code->slot_names[reg] : "<slot>");
+    } else if (reg < constant_base) {
+        snprintf(buffer, size, "t%d", reg - code->slot_count);
+    } else {
+        snprintf(buffer, size, "#%d", code->constants[reg - constant_base]);
+    }
+    return buffer;
+}
+
+/**
+ * Prints register code to the console for debugging.
+ * 
+ * @param code The register code to print
+ */
+void print_reg_code(RegCode *code) {
+    static const char *names[] = {
+        "MOVE", "LOAD_STRING", "CONCAT", "ADD", "SUB", "MUL", "DIV", "MOD", "POW",
+        "EQ", "NE", "LT", "GT", "LE", "GE", "AND", "OR", "NOT", "NEG", "STR_EQ", "STR_NE",
+        "JUMP", "JUMP_IF_FALSE", "JUMP_IF_TRUE", "HALT"
+    };
+    char dst[64], a[64], b[64];
+
+    spade_printf("\n=== REGISTER CODE ===\n");
+    for (int i = 0; i < code->count; i++) {
+        RegInstruction *instr = &code->instructions[i];
+        spade_printf("%3d: ", i);
+
+        switch (instr->opcode) {
+            case REG_HALT:
+                spade_printf("HALT\n");
+                break;
+
+            case REG_JUMP:
+                spade_printf("JUMP %d\n", instr->dst);
+                break;
+
+            case REG_JUMP_IF_FALSE:
+            case REG_JUMP_IF_TRUE:
+                spade_printf("%s %s, %d\n", names[instr->opcode],
+                       format_reg_operand(code, instr->a, a, sizeof(a)), instr->dst);
+                break;
+
+            case REG_LOAD_STRING:
+                spade_printf("LOAD_STRING %s, \"", format_reg_operand(code, instr->dst, dst, sizeof(dst)));
+                fwrite(string_table_get(code->strings, instr->a), 1,
+                       string_table_length(code->strings, instr->a), spade_stdout());
+                spade_printf("\"\n");
+                break;
+
+            case REG_MOVE:
+            case REG_NOT:
+            case REG_NEG:
+                spade_printf("%s %s, %s\n", names[instr->opcode],
+                       format_reg_operand(code, instr->dst, dst, sizeof(dst)),
+                       format_reg_operand(code, instr->a, a, sizeof(a)));
+                break;
+
+            default:
+                spade_printf("%s %s, %s, %s\n", names[instr->opcode],
+                       format_reg_operand(code, instr->dst, dst, sizeof(dst)),
+                       format_reg_operand(code, instr->a, a, sizeof(a)),
+                       format_reg_operand(code, instr->b, b, sizeof(b)));
+        }
+    }
+}
+
+/**
+ * Frees memory allocated for register code.
+ * 
+ * @param code The register code to be freed
+ */
+void free_reg_code(RegCode *code) {
+    if (!code) return;
+
+    // The string table and slot names belong to the IR code
+    free(code->constants);
     free(code->instructions);
     free(code);
-}
\ No newline at end of file
+}
@@ -2,16 +2,17 @@
 #define SPADE_IR_H
 
 #include "spade.lexer.h"
-#include "spade.parser.h"
+#include "spade.flat.h"
 #include "spade.symbol.h"
+#include "spade.string.h"
 
 
 
 typedef enum {
     IR_PUSH_CONST,      // Push constant value
-    IR_PUSH_VAR,        // Push variable value
+    IR_PUSH_VAR,        // Push value of variable slot
     IR_PUSH_STRING_LIT, // Push string literal
-    IR_STORE_VAR,       // Store top of stack to variable
+    IR_STORE_VAR,       // Store top of stack to variable slot
     IR_CONCAT,          // Concatenate two strings
     IR_ADD,             // Pop two, add, push result
     IR_SUB,             // Pop two, subtract, push result
@@ -29,32 +30,143 @@ typedef enum {
     IR_OR,              // Pop two, logical or, push result
     IR_NOT,             // Pop one, logical not, push result
     IR_NEG,             // Pop one, negate, push result
+    IR_STR_EQ,          // Pop two strings, compare contents equal, push result
+    IR_STR_NE,          // Pop two strings, compare contents not equal, push result
+
+    // Superinstructions, produced by the -O2 peephole pass
+    IR_ADD_VAR_CONST,   // Push variable slot + constant
+    IR_INC_VAR,         // Add constant to variable slot in place
+    IR_EQ_VAR_VAR,      // Push left slot == right slot
+    IR_NE_VAR_VAR,      // Push left slot != right slot
+    IR_LT_VAR_VAR,      // Push left slot < right slot
+    IR_LE_VAR_VAR,      // Push left slot <= right slot
+
+    // Control flow; targets are absolute and resolved at compile time
+    IR_JUMP,            // Continue at target
+    IR_JUMP_IF_FALSE,   // Pop one, continue at target if it is zero
+    IR_JUMP_IF_TRUE,    // Pop one, continue at target if it is non-zero
+
     IR_HALT             // End of program
 } IROpcode;
 
 typedef struct {
     IROpcode opcode;
     union {
-        int int_value;      // For constants and string indices
-        char *var_name;     // For variable operations
-        char *string_lit;   // For string literals
+        int int_value;      // For constants and string literal indices (into IRCode.strings)
+        int slot;           // For variable operations (slot assigned during IR generation)
+        int target;         // For jumps: index of the instruction to continue at (a byte offset in bytecode)
+        struct {
+            int slot;
+            int value;
+        } var_const;        // For ADD_VAR_CONST and INC_VAR
+        struct {
+            int left;
+            int right;
+        } var_pair;         // For the *_VAR_VAR comparisons
     } operand;
 } IRInstruction;
 
 typedef struct {
-    IRInstruction *instructions;
+    IRInstruction *instructions; // NULL for code loaded from an image until unpack_ir_code
     int count;
     int capacity;
+
+    char **slot_names;      // Variable name for each slot (for debugging output)
+    unsigned char *slot_is_string; // 1 for slots declared as string (GC roots in the VM)
+    int slot_count;         // Number of variable slots the program needs
+    int slot_capacity;      // Allocated capacity for slot_names
+
+    StringTable *strings;   // Interned string literals referenced by PUSH_STRING_LIT
+
+    unsigned char *bytecode; // Packed instructions the VM runs (see spade.bytecode.h), NULL until packed
+    int bytecode_size;      // Size of bytecode in bytes
+    int verified_depth;     // Maximum stack depth proven by verify_ir_code, -1 until it accepts the bytecode
+
+    SourceBuffer image;     // Image loaded code points into (data is NULL for generated code)
+
+    unsigned int source_size;           // Size of the source the code was compiled from, as recorded in images
+    unsigned long long source_digest;   // Digest of that source (see spade.cache.h); 0 if not recorded
 } IRCode;
 
+/**
+ * Register-based (three-address) instruction set.
+ * 
+ * Lowered from the stack IR by lower_ir_to_reg(). Every operand names a
+ * register: registers [0, slot_count) are the variable slots, followed by
+ * temp_count temporaries and then one register per constant, which the VM
+ * preloads before execution. `x = a + b` becomes a single REG_ADD.
+ */
+typedef enum {
+    REG_MOVE,           // dst = a
+    REG_LOAD_STRING,    // dst = pool index of string literal a
+    REG_CONCAT,         // dst = a concatenated with b (strings)
+    REG_ADD,            // dst = a + b
+    REG_SUB,            // dst = a - b
+    REG_MUL,            // dst = a * b
+    REG_DIV,            // dst = a / b
+    REG_MOD,            // dst = a % b
+    REG_POW,            // dst = a ** b
+    REG_EQ,             // dst = a == b
+    REG_NE,             // dst = a != b
+    REG_LT,             // dst = a < b
+    REG_GT,             // dst = a > b
+    REG_LE,             // dst = a <= b
+    REG_GE,             // dst = a >= b
+    REG_AND,            // dst = a and b
+    REG_OR,             // dst = a or b
+    REG_NOT,            // dst = !a
+    REG_NEG,            // dst = -a
+    REG_STR_EQ,         // dst = string a == string b
+    REG_STR_NE,         // dst = string a != string b
+    REG_JUMP,           // continue at instruction dst
+    REG_JUMP_IF_FALSE,  // continue at instruction dst if a is zero
+    REG_JUMP_IF_TRUE,   // continue at instruction dst if a is non-zero
+    REG_HALT            // End of program
+} RegOpcode;
+
+typedef struct {
+    RegOpcode opcode;
+    int dst;
+    int a;
+    int b;
+} RegInstruction;
+
+typedef struct {
+    RegInstruction *instructions;
+    int count;
+    int capacity;
+
+    int *constants;         // Values preloaded into the constant registers
+    int constant_count;
+    int constant_capacity;
+
+    StringTable *strings;   // String literals referenced by REG_LOAD_STRING (borrowed from the IR code)
+
+    int slot_count;         // Registers [0, slot_count) are the variable slots
+    int temp_count;         // Temporaries follow the slots, constants follow the temporaries
+    char **slot_names;      // Borrowed from the IR code (for debugging output)
+    unsigned char *slot_is_string; // Borrowed from the IR code
+} RegCode;
+
 // Function declarations
 IRCode *create_ir_code(void);
 void emit_instruction(IRCode *code, IROpcode opcode);
 void emit_instruction_int(IRCode *code, IROpcode opcode, int value);
-void emit_instruction_var(IRCode *code, IROpcode opcode, const char *var_name);
-void emit_instruction_string_lit(IRCode *code, IROpcode opcode, const char *string_lit);
-void generate_ir(ASTNode *ast, IRCode *code, SymbolTable *symbol_table);
+void emit_instruction_slot(IRCode *code, IROpcode opcode, int slot);
+void emit_instruction_string_lit(IRCode *code, IROpcode opcode, const char *string_lit, int length);
+int emit_jump(IRCode *code, IROpcode opcode, int target);
+void patch_jumps(IRCode *code, int chain, int target);
+int ir_is_jump(IROpcode opcode);
+void ir_stack_effect(IROpcode opcode, int *pops, int *pushes);
+int resolve_variable_slot(IRCode *code, SymbolTable *symbol_table, const char *name);
+int resolve_symbol_slot(IRCode *code, SymbolTable *symbol_table, Symbol *symbol);
+void generate_ir(FlatAST *ast, IRCode *code, SymbolTable *symbol_table);
+const char *ir_slot_name(IRCode *code, int slot);
 void print_ir_code(IRCode *code);
 void free_ir_code(IRCode *code);
 
+RegCode *lower_ir_to_reg(IRCode *code);
+void print_reg_code(RegCode *code);
+void free_reg_code(RegCode *code);
+
 #endif
\ No newline at end of file
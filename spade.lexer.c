@@ -3,71 +3,88 @@
 #include <ctype.h>
 #include <string.h>
 #include "spade.lexer.h"
+#include "spade.output.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Selects the character scanning core used by next_token.
+ *
+ * With SSE2 (always available on x86-64) whitespace runs and identifier and
+ * number bodies are classified 16 bytes per step. Other targets use plain
+ * scalar loops with the same character classes. Build with
+ * -DSPADE_SIMD_LEXER=0 to force the scalar loops.
+ */
+#ifndef SPADE_SIMD_LEXER
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPADE_SIMD_LEXER 1
+#else
+#define SPADE_SIMD_LEXER 0
+#endif
+#endif
+
+#if SPADE_SIMD_LEXER
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
 
 typedef struct {
     const char *keyword;
     enum TokenType token_type;
 } KeywordMap;
 
-const KeywordMap keywords[] = {
+/**
+ * Perfect hash over the keyword set, computed from a word's first byte, last
+ * byte and length. Every keyword lands in its own slot of keywords[], so a
+ * lookup costs one hash and at most one string comparison. A new keyword
+ * must not collide with an existing slot; the compiler flags a duplicate
+ * index with -Woverride-init.
+ */
+#define KEYWORD_HASH_SIZE 64
+#define KEYWORD_MIN_LENGTH 2
+#define KEYWORD_MAX_LENGTH 8
+#define KEYWORD_HASH(first, last, length) \
+    (((unsigned int)(length) + 8u * (unsigned char)(first) + 5u * (unsigned char)(last)) & (KEYWORD_HASH_SIZE - 1))
+
+const KeywordMap keywords[KEYWORD_HASH_SIZE] = {
     // Data types
-    {"int", TOKEN_INT},
-    {"long", TOKEN_LONG},
-    {"float", TOKEN_FLOAT},
-    {"double", TOKEN_DOUBLE},
-    {"string", TOKEN_STRING},
-    {"bool", TOKEN_BOOL},
-    {"void", TOKEN_VOID},
+    [KEYWORD_HASH('i', 't', 3)] = {"int", TOKEN_INT},
+    [KEYWORD_HASH('l', 'g', 4)] = {"long", TOKEN_LONG},
+    [KEYWORD_HASH('f', 't', 5)] = {"float", TOKEN_FLOAT},
+    [KEYWORD_HASH('d', 'e', 6)] = {"double", TOKEN_DOUBLE},
+    [KEYWORD_HASH('s', 'g', 6)] = {"string", TOKEN_STRING},
+    [KEYWORD_HASH('b', 'l', 4)] = {"bool", TOKEN_BOOL},
+    [KEYWORD_HASH('v', 'd', 4)] = {"void", TOKEN_VOID},
     
     // Control structures
-    {"if", TOKEN_IF},
-    {"else", TOKEN_ELSE},
-    {"while", TOKEN_WHILE},
-    {"for", TOKEN_FOR},
-    {"return", TOKEN_RETURN},
-    {"task", TOKEN_TASK},
-    {"and", TOKEN_AND},
-    {"or", TOKEN_OR},
-    {"class", TOKEN_CLASS},
-    {"break", TOKEN_BREAK},
-    {"continue", TOKEN_CONTINUE},
-    {"print", TOKEN_PRINT},
-    {"super", TOKEN_SUPER},
-    {"this", TOKEN_THIS},
+    [KEYWORD_HASH('i', 'f', 2)] = {"if", TOKEN_IF},
+    [KEYWORD_HASH('e', 'e', 4)] = {"else", TOKEN_ELSE},
+    [KEYWORD_HASH('w', 'e', 5)] = {"while", TOKEN_WHILE},
+    [KEYWORD_HASH('f', 'r', 3)] = {"for", TOKEN_FOR},
+    [KEYWORD_HASH('r', 'n', 6)] = {"return", TOKEN_RETURN},
+    [KEYWORD_HASH('t', 'k', 4)] = {"task", TOKEN_TASK},
+    [KEYWORD_HASH('a', 'd', 3)] = {"and", TOKEN_AND},
+    [KEYWORD_HASH('o', 'r', 2)] = {"or", TOKEN_OR},
+    [KEYWORD_HASH('c', 's', 5)] = {"class", TOKEN_CLASS},
+    [KEYWORD_HASH('b', 'k', 5)] = {"break", TOKEN_BREAK},
+    [KEYWORD_HASH('c', 'e', 8)] = {"continue", TOKEN_CONTINUE},
+    [KEYWORD_HASH('p', 't', 5)] = {"print", TOKEN_PRINT},
+    [KEYWORD_HASH('s', 'r', 5)] = {"super", TOKEN_SUPER},
+    [KEYWORD_HASH('t', 's', 4)] = {"this", TOKEN_THIS},
     
     // Boolean literals
-    {"true", TOKEN_TRUE},
-    {"false", TOKEN_FALSE},
+    [KEYWORD_HASH('t', 'e', 4)] = {"true", TOKEN_TRUE},
+    [KEYWORD_HASH('f', 'e', 5)] = {"false", TOKEN_FALSE},
     
     // Literals
-    {"null", TOKEN_NULL}
-};
-
-const KeywordMap operators[] = {
-    {"=", TOKEN_ASSIGN},
-    {"+", TOKEN_PLUS},
-    {"-", TOKEN_MINUS},
-    {"*", TOKEN_MULTIPLY},
-    {"**", TOKEN_POWER},
-    {"/", TOKEN_DIVIDE},
-    {"%", TOKEN_MODULO},
-    {"==", TOKEN_EQUALS},
-    {"!=", TOKEN_NOT_EQUALS},
-    {"<", TOKEN_LESS_THAN},
-    {">", TOKEN_GREATER_THAN},
-    {"<=", TOKEN_LESS_THAN_EQUALS},
-    {">=", TOKEN_GREATER_THAN_EQUALS},
-
-    {"!", TOKEN_NOT},
-    {"(", TOKEN_LPAREN},
-    {")", TOKEN_RPAREN},
-    {"{", TOKEN_LBRACE},
-    {"}", TOKEN_RBRACE},
-    {"[", TOKEN_LBRACKET},
-    {"]", TOKEN_RBRACKET},
-    {";", TOKEN_SEMICOLON},
-    {",", TOKEN_COMMA},
-    {"->", TOKEN_ARROW},
+    [KEYWORD_HASH('n', 'l', 4)] = {"null", TOKEN_NULL},
 };
 
 const char *token_type_strings[] = {
@@ -147,21 +164,23 @@ const char *get_token_name(enum TokenType type) {
  * @param token The token to be printed, containing its type and value
  */
 void print_token(Token token) {
-    printf("[Token] Value: %s \t Type: %s\n", token.value, get_token_name(token.type));
+    spade_printf("[Token] Value: %.*s \t Type: %s\n", token.length, token.start, get_token_name(token.type));
 }
 
 /**
- * Determines if an identifier string matches a language keyword.
+ * Determines if an identifier matches a language keyword.
  * 
- * @param identifier The string to check against the keyword list
+ * @param identifier The identifier's text (not NUL-terminated)
+ * @param length The identifier's length in bytes
  * @return The corresponding TokenType if it's a keyword, TOKEN_IDENTIFIER otherwise
  */
-int get_keyword_token(char *identifier) {
-    int len = sizeof(keywords) / sizeof(keywords[0]);
-    for (int i = 0; i < len; i++) {
-        if (strcmp(identifier, keywords[i].keyword) == 0) {
-            return keywords[i].token_type;
-        }
+int get_keyword_token(const char *identifier, int length) {
+    if (length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH) {
+        return TOKEN_IDENTIFIER;
+    }
+    const KeywordMap *entry = &keywords[KEYWORD_HASH(identifier[0], identifier[length - 1], length)];
+    if (entry->keyword && strncmp(identifier, entry->keyword, length) == 0 && entry->keyword[length] == '\0') {
+        return entry->token_type;
     }
     return TOKEN_IDENTIFIER; // Not a keyword, so it's an identifier
 }
@@ -169,14 +188,42 @@ int get_keyword_token(char *identifier) {
 /**
  * Determines if a string matches a language operator.
  * 
- * @param operator The string to check against the operator list
+ * Operators are one or two bytes long, so they are classified directly by
+ * switching on their bytes.
+ * 
+ * @param operator The operator's text (not NUL-terminated)
+ * @param length The operator's length in bytes
  * @return The corresponding TokenType if it's an operator, -1 if not found
  */
-int get_operator_token(char *operator) {
-    int len = sizeof(operators) / sizeof(operators[0]);
-    for (int i = 0; i < len; i++) {
-        if (strcmp(operator, operators[i].keyword) == 0) {
-            return operators[i].token_type;
+int get_operator_token(const char *operator, int length) {
+    if (length == 1) {
+        switch (operator[0]) {
+            case '=': return TOKEN_ASSIGN;
+            case '+': return TOKEN_PLUS;
+            case '-': return TOKEN_MINUS;
+            case '*': return TOKEN_MULTIPLY;
+            case '/': return TOKEN_DIVIDE;
+            case '%': return TOKEN_MODULO;
+            case '<': return TOKEN_LESS_THAN;
+            case '>': return TOKEN_GREATER_THAN;
+            case '!': return TOKEN_NOT;
+            case '(': return TOKEN_LPAREN;
+            case ')': return TOKEN_RPAREN;
+            case '{': return TOKEN_LBRACE;
+            case '}': return TOKEN_RBRACE;
+            case '[': return TOKEN_LBRACKET;
+            case ']': return TOKEN_RBRACKET;
+            case ';': return TOKEN_SEMICOLON;
+            case ',': return TOKEN_COMMA;
+        }
+    } else if (length == 2) {
+        switch (operator[0]) {
+            case '*': if (operator[1] == '*') return TOKEN_POWER; break;
+            case '=': if (operator[1] == '=') return TOKEN_EQUALS; break;
+            case '!': if (operator[1] == '=') return TOKEN_NOT_EQUALS; break;
+            case '<': if (operator[1] == '=') return TOKEN_LESS_THAN_EQUALS; break;
+            case '>': if (operator[1] == '=') return TOKEN_GREATER_THAN_EQUALS; break;
+            case '-': if (operator[1] == '>') return TOKEN_ARROW; break;
         }
     }
 
@@ -184,185 +231,346 @@ int get_operator_token(char *operator) {
 }
 
 
+#if SPADE_SIMD_LEXER
+/**
+ * Returns the index of the lowest set bit of a non-zero mask.
+ * 
+ * @param mask A non-zero bit mask
+ * @return The index of its lowest set bit
+ */
+int first_set_bit(unsigned int mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * Marks the bytes of a 16-byte chunk whose value lies in [low, high].
+ * 
+ * Bytes of 0x80 and above compare as negative, so they never match a range
+ * of ASCII characters.
+ */
+#define SIMD_IN_RANGE(chunk, low, high) \
+    _mm_and_si128(_mm_cmpgt_epi8((chunk), _mm_set1_epi8((char)((low) - 1))), \
+                  _mm_cmplt_epi8((chunk), _mm_set1_epi8((char)((high) + 1))))
+#endif
+
+/**
+ * Skips a run of whitespace.
+ * 
+ * @param bytes The source buffer
+ * @param pos Offset to start scanning at
+ * @param size Size of the source buffer
+ * @return Offset of the first non-whitespace byte, or size
+ */
+size_t skip_whitespace(const unsigned char *bytes, size_t pos, size_t size) {
+#if SPADE_SIMD_LEXER
+    const __m128i space = _mm_set1_epi8(' ');
+    while (pos + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + pos));
+        // ' ' and '\t' through '\r' are the whitespace bytes recognized by isspace
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, space), SIMD_IN_RANGE(chunk, '\t', '\r'));
+        unsigned int other = ~(unsigned int)_mm_movemask_epi8(blank) & 0xFFFF;
+        if (other) return pos + first_set_bit(other);
+        pos += 16;
+    }
+#endif
+    while (pos < size && isspace(bytes[pos])) pos++;
+    return pos;
+}
+
+/**
+ * Finds the end of an identifier or keyword.
+ * 
+ * @param bytes The source buffer
+ * @param pos Offset to start scanning at
+ * @param size Size of the source buffer
+ * @return Offset of the first byte that is not a letter, digit or underscore, or size
+ */
+size_t scan_word(const unsigned char *bytes, size_t pos, size_t size) {
+#if SPADE_SIMD_LEXER
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i underscore = _mm_set1_epi8('_');
+    while (pos + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + pos));
+        // Setting bit 5 folds 'A'-'Z' onto 'a'-'z' without creating new letters
+        __m128i letter = SIMD_IN_RANGE(_mm_or_si128(chunk, case_bit), 'a', 'z');
+        __m128i word = _mm_or_si128(_mm_or_si128(letter, SIMD_IN_RANGE(chunk, '0', '9')),
+                                    _mm_cmpeq_epi8(chunk, underscore));
+        unsigned int other = ~(unsigned int)_mm_movemask_epi8(word) & 0xFFFF;
+        if (other) return pos + first_set_bit(other);
+        pos += 16;
+    }
+#endif
+    while (pos < size && (isalnum(bytes[pos]) || bytes[pos] == '_')) pos++;
+    return pos;
+}
+
+/**
+ * Finds the end of a run of decimal digits.
+ * 
+ * @param bytes The source buffer
+ * @param pos Offset to start scanning at
+ * @param size Size of the source buffer
+ * @return Offset of the first non-digit byte, or size
+ */
+size_t scan_digits(const unsigned char *bytes, size_t pos, size_t size) {
+#if SPADE_SIMD_LEXER
+    while (pos + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(bytes + pos));
+        unsigned int other = ~(unsigned int)_mm_movemask_epi8(SIMD_IN_RANGE(chunk, '0', '9')) & 0xFFFF;
+        if (other) return pos + first_set_bit(other);
+        pos += 16;
+    }
+#endif
+    while (pos < size && isdigit(bytes[pos])) pos++;
+    return pos;
+}
+
 /**
- * Creates a token from an identifier string based on whether it's a word or operator.
+ * Creates a token for a span of source text based on whether it's a word or operator.
  * 
- * @param identifier The string value for the token
- * @param is_word 1 if the identifier is a word (keyword/identifier), 0 if it's an operator
- * @return A Token structure with the appropriate type and value
+ * @param start The first byte of the token's text
+ * @param length The length of the token's text in bytes
+ * @param is_word 1 if the span is a word (keyword/identifier), 0 if it's an operator
+ * @return A Token structure with the appropriate type, pointing at the span
  */
-Token token_type(char *identifier, int is_word){
+Token token_type(const char *start, int length, int is_word){
     Token tk;
     if(is_word){
-        tk.type = get_keyword_token(identifier);
-        tk.value = strdup(identifier);
+        tk.type = get_keyword_token(start, length);
     }else{
-        tk.type = get_operator_token(identifier);
-        tk.value = strdup(identifier);
+        tk.type = get_operator_token(start, length);
     }
+    tk.start = start;
+    tk.length = length;
 
     return tk;
 }
 
 /**
- * Frees memory allocated for an array of tokens.
+ * Reads a whole file into a heap buffer.
+ * 
+ * Used where memory mapping is unavailable, and for inputs that cannot be
+ * mapped such as pipes.
  * 
- * @param token The array of tokens to be freed
- * @param token_count The number of tokens in the array
+ * @param filename The path to the source file
+ * @param source Receives the file's contents
+ * @return 1 on success, 0 if the file cannot be opened or read
  */
-void free_tokens(Token *token, int token_count){
-    for(int i = 0; i < token_count; i++){
-        if(token[i].value != NULL){
-            free(token[i].value);
-            token[i].value = NULL;
+int read_source(const char *filename, SourceBuffer *source){
+    FILE *file = fopen(filename, "rb");
+    if(!file) return 0;
+
+    size_t size = 0;
+    size_t capacity = 4096;
+    char *data = malloc(capacity);
+    size_t read;
+    while(data && (read = fread(data + size, 1, capacity - size, file)) > 0){
+        size += read;
+        if(size == capacity){
+            capacity *= 2;
+            char *grown = realloc(data, capacity);
+            if(!grown){
+                free(data);
+                data = NULL;
+                break;
+            }
+            data = grown;
         }
     }
+    fclose(file);
+    if(!data) return 0;
+
+    source->data = data;
+    source->size = size;
+    source->mapped = 0;
+    return 1;
 }
 
+/**
+ * Opens a source file for lexing, memory-mapping it where possible.
+ * 
+ * @param filename The path to the source file
+ * @param source Receives the file's contents
+ * @return 1 on success, 0 if the file cannot be opened or read
+ */
+int open_source(const char *filename, SourceBuffer *source){
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) return 0;
+
+    struct stat info;
+    if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0){
+        void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED){
+            close(fd);
+            source->data = data;
+            source->size = (size_t)info.st_size;
+            source->mapped = 1;
+            return 1;
+        }
+    }
+    close(fd);
+#endif
+    return read_source(filename, source);
+}
 
 /**
- * Performs lexical analysis on a given file and populates a token array.
+ * Releases a source buffer opened with open_source.
  * 
- * This function reads a source file character by character and converts it into
- * a sequence of tokens. It handles identifiers, keywords, numbers, operators,
- * punctuation, and string literals.
+ * @param source The buffer to release; tokens pointing into it become invalid
+ */
+void close_source(SourceBuffer *source){
+    if(!source->data) return;
+#ifndef _WIN32
+    if(source->mapped){
+        munmap((void *)source->data, source->size);
+    }else
+#endif
+    {
+        free((void *)source->data);
+    }
+    source->data = NULL;
+    source->size = 0;
+    source->mapped = 0;
+}
+
+
+/**
+ * Opens a source file and positions a lexer at its first token.
  * 
+ * @param lexer The lexer to initialize
  * @param filename The path to the source file to be lexically analyzed
- * @param token_array A pre-allocated array to store the generated tokens
- * @param max_tokens The maximum number of tokens that can be stored in the token_array
- * @return The number of tokens successfully parsed, or 0 if file cannot be opened
+ * @return 1 on success, 0 if the file cannot be opened
  */
-int lexer(char *filename, Token *token_array, int max_tokens){
-    FILE *file = fopen(filename, "rb");
-    if(!file){
-        printf("Error opening file: %s\n", filename);
+int open_lexer(Lexer *lexer, const char *filename){
+    lexer->source.data = NULL;
+    lexer->source.size = 0;
+    lexer->source.mapped = 0;
+    lexer->pos = 0;
+    lexer->error = 0;
+    if(!open_source(filename, &lexer->source)){
+        spade_printf("Error opening file: %s\n", filename);
         return 0;
     }
-    int byte;
-    int token_index = 0;
-    int token_count = 0;
-    while((byte = fgetc(file)) != EOF){
-        if(isspace(byte)){
-            continue; // skip if whitespace
-        }else if(isalpha(byte) || byte == '_'){ 
+    return 1;
+}
+
+/**
+ * Moves a lexer back to the start of its source.
+ * 
+ * @param lexer The lexer to rewind
+ */
+void rewind_lexer(Lexer *lexer){
+    lexer->pos = 0;
+    lexer->error = 0;
+}
+
+/**
+ * Releases a lexer's source buffer.
+ * 
+ * @param lexer The lexer to close; tokens it produced become invalid
+ */
+void close_lexer(Lexer *lexer){
+    close_source(&lexer->source);
+    lexer->pos = 0;
+}
+
+/**
+ * Scans and returns the next token.
+ * 
+ * Scanning works in place on the source buffer. Tokens are spans into it, so
+ * no token text is copied or allocated, and only one token is materialized
+ * at a time. It handles identifiers, keywords, numbers, operators,
+ * punctuation, string literals and line comments.
+ * 
+ * A lexical error is reported and ends the stream early instead of exiting,
+ * so under -j only the file it occurs in fails.
+ * 
+ * @param lexer The lexer to read from
+ * @return The next token, or a TOKEN_EOF token once the source is exhausted
+ *         or after a lexical error (which sets lexer->error)
+ */
+Token next_token(Lexer *lexer){
+    const char *text = lexer->source.data;
+    const unsigned char *bytes = (const unsigned char *)text;
+    size_t size = lexer->source.size;
+    size_t pos = lexer->pos;
+    Token tk;
+    while((pos = skip_whitespace(bytes, pos, size)) < size){
+        int byte = bytes[pos];
+        size_t start = pos++;
+        if(isalpha(byte) || byte == '_'){ 
             // identifier
-            char buffer[256];
-            int index = 0;
-            buffer[index++] = byte;
-            while((byte = fgetc(file)) != EOF && (isalnum(byte) || byte == '_')){
-                if(index < 256) buffer[index++] = byte;
-            }
+            pos = scan_word(bytes, pos, size);
 
-            buffer[index] = '\0';
-            Token tk = token_type(buffer, 1);
-            if(token_index < max_tokens) token_array[token_index++] = tk;
-            token_count++;
-            if(byte != EOF) ungetc(byte, file);
+            tk = token_type(text + start, (int)(pos - start), 1);
+            lexer->pos = pos;
+            return tk;
 
         }else if(isdigit(byte)){
             // numbers
-            char buffer[256];
-            int index = 0;
-            buffer[index++] = byte;
+            pos = scan_digits(bytes, pos, size);
 
-            while((byte = fgetc(file)) != EOF && isdigit(byte)){
-                if(index < 256) buffer[index++] = byte;
-            }
-            buffer[index] = '\0';
             // create a token for number TODO: handle floats, doubles, etc.
-            Token tk;
             tk.type = TOKEN_NUMBER;
-            tk.value = strdup(buffer);
-            if(token_index < max_tokens) token_array[token_index++] = tk;
-            token_count++;
-            if(byte != EOF) ungetc(byte, file);
+            tk.start = text + start;
+            tk.length = (int)(pos - start);
+            lexer->pos = pos;
+            return tk;
         }else if(ispunct(byte)){
             // punctuation
-            char buffer[256];
-            int index = 0;
-            buffer[index++] = byte;
-            int next_byte = fgetc(file);
-            if(next_byte != EOF){ // check if there's another character to avoid tokens making combinations that don't exist
-                if((byte == '=' && next_byte == '=') || (byte == '!' && next_byte == '=') ||
-                    (byte == '<' && next_byte == '=') || (byte == '>' && next_byte == '=') || 
-                    (byte == '&' && next_byte == '&') || (byte == '|' && next_byte == '|') || 
-                    (byte == '-' && next_byte == '>') || (byte == '(' && next_byte == ')') ||
-                    (byte == '{' && next_byte == '}') || (byte == '[' && next_byte == ']') ||
-                    (byte == '*' && next_byte == '*')){
-                    // it's a two character token{
-
-                    // check for empty brackets
-                    if((byte == '(' || byte == '[' || byte == '{') && (next_byte == ')' || next_byte == ']' || next_byte == '}')){
-                        buffer[index] = '\0';
-                        Token tk = token_type(buffer, 0); // convert first character to token
-                        if(token_index < max_tokens) token_array[token_index++] = tk; // add token to array
-                        token_count++;
-                        index = 0; // reset index to clear buffer
-                        buffer[index++] = next_byte;
-                        buffer[index] = '\0';
-                        tk = token_type(buffer, 0); // convert second character to token
-                        if(token_index < max_tokens) token_array[token_index++] = tk; // add token to array
-                        token_count++;
-                        continue;
-                    
-                    }else{
-
-                        buffer[index++] = next_byte;
-                        buffer[index] = '\0';
-                        Token tk = token_type(buffer, 0);
-                        if(token_index < max_tokens) token_array[token_index++] = tk;
-                        token_count++;
-                        continue;
-                    }
-
-                }else{
-                    ungetc(next_byte, file);
-                }
+            int next_byte = pos < size ? bytes[pos] : EOF;
+
+            // check for a two character token; empty brackets such as "()" stay two separate tokens
+            if((byte == '=' && next_byte == '=') || (byte == '!' && next_byte == '=') ||
+                (byte == '<' && next_byte == '=') || (byte == '>' && next_byte == '=') || 
+                (byte == '&' && next_byte == '&') || (byte == '|' && next_byte == '|') || 
+                (byte == '-' && next_byte == '>') || (byte == '*' && next_byte == '*')){
+                tk = token_type(text + start, 2, 0);
+                lexer->pos = pos + 1;
+                return tk;
             }
 
             if(byte == '"'){
-                index = 0;
-                // check for string literal
-                while((byte = fgetc(file)) != EOF && byte != '"'){
-                    if(index < 256) buffer[index++] = byte;
-                }
-
-                if(byte != '"'){
-                    printf("Error: Unterminated string literal\n");
-                    exit(1);
+                // check for string literal; the token spans the bytes between the quotes
+                const char *close = memchr(text + pos, '"', size - pos);
+                if(!close){
+                    spade_printf("Error: Unterminated string literal\n");
+                    lexer->error = 1;
+                    pos = size;
+                    break;
                 }
 
-                buffer[index] = '\0';
-                Token tk;
                 tk.type = TOKEN_STRING_LITERAL;
-                tk.value = strdup(buffer);
-                if(token_index < max_tokens) token_array[token_index++] = tk;
-                token_count++;
-                continue;
+                tk.start = text + pos;
+                tk.length = (int)(close - (text + pos));
+                lexer->pos = (size_t)(close - text) + 1;
+                return tk;
             }
 
             // check for comments
             if(byte == '/' && next_byte == '/'){
-                while ((byte = fgetc(file)) != '\n'){
-                    /* code */
-                    // buffer[0] = byte;
-                    // buffer[1] = '\0';
-                    continue; // consume  all characters until newline
-                }
-
+                // memchr jumps to the newline a vector at a time in every mainstream libc
+                const char *newline = memchr(text + pos, '\n', size - pos);
+                pos = newline ? (size_t)(newline - text) + 1 : size; // consume all characters until newline
                 continue;
             }
 
-            buffer[index] = '\0';
-            Token tk = token_type(buffer, 0);
-            if(token_index < max_tokens) token_array[token_index++] = tk;
-            token_count++;
+            tk = token_type(text + start, 1, 0);
+            lexer->pos = pos;
+            return tk;
         }
     }
 
-    Token tk = {TOKEN_EOF, "EOF"};
-    if(token_index < max_tokens) token_array[token_index++] = tk;
-
-    fclose(file);
-    return token_count;
-}
\ No newline at end of file
+    lexer->pos = pos;
+    tk.type = TOKEN_EOF;
+    tk.start = "EOF";
+    tk.length = 3;
+    return tk;
+}
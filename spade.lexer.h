@@ -1,6 +1,8 @@
 #ifndef SPADE_LEXER_H
 #define SPADE_LEXER_H
 
+#include <stddef.h>
+
 /**
  * Defines the types of tokens that can be recognized during lexical analysis.
  *
@@ -71,14 +73,37 @@ enum TokenType{
 /**
  * Represents a token in the lexical analysis process.
  *
+ * Tokens are spans into the source buffer rather than copies: start points at
+ * the token's first byte and is not NUL-terminated. String literal spans
+ * exclude the surrounding quotes and may contain NUL bytes.
+ *
  * @param type The type of the token (e.g., identifier, keyword, number)
- * @param value The string value associated with the token
+ * @param start The first byte of the token's text
+ * @param length The length of the token's text in bytes
  */
 typedef struct {
     enum TokenType type;
-    char *value;
+    const char *start;
+    int length;
 } Token;
 
+/**
+ * The contents of a source file.
+ *
+ * On POSIX systems the file is memory-mapped read-only, so lexing never copies
+ * it; elsewhere, or if mapping fails, it is read into a heap buffer. Tokens
+ * point into data, so the buffer must stay open until parsing is done.
+ *
+ * @param data The file's bytes (not NUL-terminated)
+ * @param size The number of bytes in data
+ * @param mapped 1 if data is a memory mapping, 0 if it is heap-allocated
+ */
+typedef struct {
+    const char *data;
+    size_t size;
+    int mapped;
+} SourceBuffer;
+
 /**
  * Converts a token type enum to its corresponding string representation.
  *
@@ -95,21 +120,67 @@ const char *get_token_name(enum TokenType type);
 void print_token(Token token);
 
 /**
- * Frees memory allocated for an array of tokens.
+ * Opens a source file for lexing, memory-mapping it where possible.
+ *
+ * @param filename The path to the source file
+ * @param source Receives the file's contents
+ * @return 1 on success, 0 if the file cannot be opened or read
+ */
+int open_source(const char *filename, SourceBuffer *source);
+
+/**
+ * Releases a source buffer opened with open_source.
+ *
+ * @param source The buffer to release; tokens pointing into it become invalid
+ */
+void close_source(SourceBuffer *source);
+
+/**
+ * A pull-based token stream over one source file.
+ *
+ * Tokens are produced on demand by next_token, so memory use does not grow
+ * with the size of the file.
  *
- * @param token The array of tokens to be freed
- * @param token_count The number of tokens in the array
+ * @param source The source buffer tokens point into
+ * @param pos Offset of the next byte to scan
+ * @param error Set once a lexical error has been reported; the stream then ends with TOKEN_EOF
  */
-void free_tokens(Token *token, int token_count);
+typedef struct {
+    SourceBuffer source;
+    size_t pos;
+    int error;
+} Lexer;
 
 /**
- * Performs lexical analysis on a given file and populates a token array.
+ * Opens a source file and positions a lexer at its first token.
  *
+ * @param lexer The lexer to initialize
  * @param filename The path to the source file to be lexically analyzed
- * @param token_array A pre-allocated array to store the generated tokens
- * @param max_tokens The maximum number of tokens that can be stored in the token_array
- * @return The number of tokens successfully parsed, or a negative error code if lexing fails
+ * @return 1 on success, 0 if the file cannot be opened
+ */
+int open_lexer(Lexer *lexer, const char *filename);
+
+/**
+ * Scans and returns the next token.
+ *
+ * @param lexer The lexer to read from
+ * @return The next token, or a TOKEN_EOF token once the source is exhausted
+ *         or after a lexical error (which sets lexer->error)
+ */
+Token next_token(Lexer *lexer);
+
+/**
+ * Moves a lexer back to the start of its source.
+ *
+ * @param lexer The lexer to rewind
+ */
+void rewind_lexer(Lexer *lexer);
+
+/**
+ * Releases a lexer's source buffer.
+ *
+ * @param lexer The lexer to close; tokens it produced become invalid
  */
-int lexer(char *filename, Token *token_array, int max_tokens);
+void close_lexer(Lexer *lexer);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,522 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "spade.ir.h"
+#include "spade.vm.h"
+#include "spade.opt.h"
+
+/**
+ * Finds the first instruction of the expression that ends at a given index.
+ * 
+ * Walks backwards using each instruction's stack effect until exactly one
+ * value has been produced, which is the operand computed by the code range.
+ * 
+ * @param instructions The instruction array to search
+ * @param end Index of the last instruction of the expression
+ * @return Index of the first instruction of the expression, or -1 if there is none
+ */
+int ir_operand_start(IRInstruction *instructions, int end) {
+    int needed = 1;
+    for (int i = end; i >= 0; i--) {
+        int pops, pushes;
+        ir_stack_effect(instructions[i].opcode, &pops, &pushes);
+        needed += pops - pushes;
+        if (needed == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Evaluates a binary operator on two constants the way the VM would.
+ * 
+ * Arithmetic wraps like the VM's int arithmetic. Operations that raise a
+ * runtime error in the VM (division or modulo by zero, INT_MIN / -1, power
+ * overflow) are left alone so the error still happens when the program runs.
+ * 
+ * @param opcode The binary operator
+ * @param left The left operand
+ * @param right The right operand
+ * @param result Pointer to store the folded value
+ * @return 1 if the operation was folded, 0 if it must stay in the code
+ */
+int fold_binary(IROpcode opcode, int left, int right, int *result) {
+    switch (opcode) {
+        case IR_ADD: *result = (int)((unsigned int)left + (unsigned int)right); return 1;
+        case IR_SUB: *result = (int)((unsigned int)left - (unsigned int)right); return 1;
+        case IR_MUL: *result = (int)((unsigned int)left * (unsigned int)right); return 1;
+
+        case IR_DIV:
+        case IR_MOD:
+            if (right == 0 || (left == INT_MIN && right == -1)) {
+                return 0;
+            }
+            *result = opcode == IR_DIV ? left / right : left % right;
+            return 1;
+
+        case IR_POW:
+            return safe_int_power(left, right, result, 0) == VM_SUCCESS;
+
+        case IR_EQ:  *result = left == right; return 1;
+        case IR_NE:  *result = left != right; return 1;
+        case IR_LT:  *result = left < right; return 1;
+        case IR_GT:  *result = left > right; return 1;
+        case IR_LE:  *result = left <= right; return 1;
+        case IR_GE:  *result = left >= right; return 1;
+        case IR_AND: *result = (left && right) ? 1 : 0; return 1;
+        case IR_OR:  *result = (left || right) ? 1 : 0; return 1;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * Checks whether a constant is a right identity of an operator (x op k == x).
+ * 
+ * @param opcode The binary operator
+ * @param value The constant right operand
+ * @return 1 if the operator can be dropped together with the constant
+ */
+int is_right_identity(IROpcode opcode, int value) {
+    switch (opcode) {
+        case IR_ADD:
+        case IR_SUB: return value == 0;
+        case IR_MUL:
+        case IR_DIV:
+        case IR_POW: return value == 1;
+        default:     return 0;
+    }
+}
+
+/**
+ * Checks whether a constant is a left identity of an operator (k op x == x).
+ * 
+ * @param opcode The binary operator
+ * @param value The constant left operand
+ * @return 1 if the operator can be dropped together with the constant
+ */
+int is_left_identity(IROpcode opcode, int value) {
+    switch (opcode) {
+        case IR_ADD: return value == 0;
+        case IR_MUL: return value == 1;
+        default:     return 0;
+    }
+}
+
+/**
+ * Tries to simplify the instructions at the end of a partially rewritten code array.
+ * 
+ * @param out The rewritten instructions
+ * @param count Pointer to the number of rewritten instructions, updated on success
+ * @param strings The string literal table, which receives folded concatenations
+ * @return 1 if a rewrite happened, 0 otherwise
+ */
+int simplify_tail(IRInstruction *out, int *count, StringTable *strings) {
+    int n = *count;
+    if (n < 2) return 0;
+
+    IRInstruction *op = &out[n - 1];
+    IRInstruction *right = &out[n - 2];
+
+    // Unary operator on a constant
+    if ((op->opcode == IR_NEG || op->opcode == IR_NOT) && right->opcode == IR_PUSH_CONST) {
+        int value = right->operand.int_value;
+        right->operand.int_value = op->opcode == IR_NEG ? (int)(0u - (unsigned int)value) : !value;
+        *count = n - 1;
+        return 1;
+    }
+
+    // A branch on a constant is either always taken (a plain jump) or never (dropped)
+    if ((op->opcode == IR_JUMP_IF_FALSE || op->opcode == IR_JUMP_IF_TRUE) && right->opcode == IR_PUSH_CONST) {
+        int taken = (right->operand.int_value != 0) == (op->opcode == IR_JUMP_IF_TRUE);
+        if (taken) {
+            right->opcode = IR_JUMP;
+            right->operand.target = op->operand.target;
+            *count = n - 1;
+        } else {
+            *count = n - 2;
+        }
+        return 1;
+    }
+
+    int pops, pushes;
+    ir_stack_effect(op->opcode, &pops, &pushes);
+    if (pops != 2) return 0;
+
+    // Two string literals concatenate at compile time
+    if (op->opcode == IR_CONCAT && n >= 3 &&
+        out[n - 3].opcode == IR_PUSH_STRING_LIT && right->opcode == IR_PUSH_STRING_LIT) {
+        int left_index = out[n - 3].operand.int_value;
+        int right_index = right->operand.int_value;
+        int left_len = string_table_length(strings, left_index);
+        int right_len = string_table_length(strings, right_index);
+        char *joined = malloc(left_len + right_len + 1);
+        if (!joined) return 0;
+        memcpy(joined, string_table_get(strings, left_index), left_len);
+        memcpy(joined + left_len, string_table_get(strings, right_index), right_len);
+        int index = intern_string_length(strings, joined, left_len + right_len);
+        free(joined);
+        if (index < 0) return 0;
+        out[n - 3].operand.int_value = index;
+        *count = n - 2;
+        return 1;
+    }
+
+    // Literals are interned, so two literals are equal exactly when their indices are
+    if ((op->opcode == IR_STR_EQ || op->opcode == IR_STR_NE) && n >= 3 &&
+        out[n - 3].opcode == IR_PUSH_STRING_LIT && right->opcode == IR_PUSH_STRING_LIT) {
+        int equal = out[n - 3].operand.int_value == right->operand.int_value;
+        out[n - 3].opcode = IR_PUSH_CONST;
+        out[n - 3].operand.int_value = op->opcode == IR_STR_EQ ? equal : !equal;
+        *count = n - 2;
+        return 1;
+    }
+
+    if (right->opcode != IR_PUSH_CONST) return 0;
+
+    // Both operands constant: replace the whole expression with its value
+    if (n >= 3 && out[n - 3].opcode == IR_PUSH_CONST) {
+        int value;
+        if (fold_binary(op->opcode, out[n - 3].operand.int_value, right->operand.int_value, &value)) {
+            out[n - 3].operand.int_value = value;
+            *count = n - 2;
+            return 1;
+        }
+        return 0;
+    }
+
+    // x + 0, x - 0, x * 1, x / 1, x ** 1
+    if (is_right_identity(op->opcode, right->operand.int_value)) {
+        *count = n - 2;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Tries to drop a constant left operand that is an identity (0 + x, 1 * x).
+ * 
+ * @param out The rewritten instructions
+ * @param count Pointer to the number of rewritten instructions, updated on success
+ * @return 1 if a rewrite happened, 0 otherwise
+ */
+int simplify_left_identity(IRInstruction *out, int *count) {
+    int n = *count;
+    if (n < 3) return 0;
+
+    IRInstruction *op = &out[n - 1];
+    if (op->opcode != IR_ADD && op->opcode != IR_MUL) return 0;
+
+    int right_start = ir_operand_start(out, n - 2);
+    if (right_start < 1) return 0;
+
+    IRInstruction *left = &out[right_start - 1];
+    if (left->opcode != IR_PUSH_CONST || !is_left_identity(op->opcode, left->operand.int_value)) {
+        return 0;
+    }
+
+    // Slide the right operand over the constant and drop the operator
+    memmove(&out[right_start - 1], &out[right_start], sizeof(IRInstruction) * (n - 1 - right_start));
+    *count = n - 2;
+    return 1;
+}
+
+/**
+ * Prepares a rewriting pass for code that contains jumps.
+ * 
+ * Rewrites only look at the tail of the output, so jumps stay correct as
+ * long as no rewrite reaches back past an instruction something jumps to,
+ * and every target is moved to where its instruction ends up. The passes
+ * record that position in map and start the rewritable tail at each target.
+ * 
+ * @param code The IR code about to be rewritten
+ * @param map Receives an array of count + 1 output positions, or NULL if the code has no jumps
+ * @param is_target Receives per-instruction flags for jump targets, or NULL if the code has no jumps
+ * @return 1 if the pass can run, 0 if memory ran out
+ */
+int begin_jump_remap(IRCode *code, int **map, unsigned char **is_target) {
+    *map = NULL;
+    *is_target = NULL;
+
+    int has_jumps = 0;
+    for (int i = 0; i < code->count && !has_jumps; i++) {
+        has_jumps = ir_is_jump(code->instructions[i].opcode);
+    }
+    if (!has_jumps) return 1;
+
+    *map = malloc(sizeof(int) * (code->count + 1));
+    *is_target = calloc(code->count + 1, 1);
+    if (!*map || !*is_target) {
+        free(*map);
+        free(*is_target);
+        return 0;
+    }
+
+    for (int i = 0; i < code->count; i++) {
+        int target = code->instructions[i].operand.target;
+        if (ir_is_jump(code->instructions[i].opcode) && target >= 0 && target <= code->count) {
+            (*is_target)[target] = 1;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Moves every jump's target to the new position of its instruction.
+ * 
+ * @param code The rewritten IR code (count is the rewritten length)
+ * @param old_count Number of instructions before the rewrite
+ * @param map Output position of every original instruction, from begin_jump_remap (may be NULL)
+ * @param is_target Jump target flags from begin_jump_remap (may be NULL)
+ */
+void end_jump_remap(IRCode *code, int old_count, int *map, unsigned char *is_target) {
+    if (map) {
+        map[old_count] = code->count;
+        for (int i = 0; i < code->count; i++) {
+            IRInstruction *instr = &code->instructions[i];
+            if (ir_is_jump(instr->opcode) && instr->operand.target >= 0 && instr->operand.target <= old_count) {
+                instr->operand.target = map[instr->operand.target];
+            }
+        }
+    }
+    free(map);
+    free(is_target);
+}
+
+/**
+ * Tries to merge a conditional branch with the jump appended after it.
+ * 
+ * `JUMP_IF_FALSE next; JUMP target; next:` is `JUMP_IF_TRUE target`, the
+ * shape of `if (...) break;`, and the same holds with the conditions
+ * swapped. Targets are still the original instruction indices here.
+ * 
+ * @param out The rewritten instructions
+ * @param count Number of rewritten instructions (the branch, if any, is the last one)
+ * @param jump The unconditional jump about to be appended
+ * @param index The jump's original index
+ * @return 1 if the jump was merged into the branch, 0 if it must be appended
+ */
+int merge_branch_over_jump(IRInstruction *out, int count, IRInstruction *jump, int index) {
+    if (count < 1 || jump->opcode != IR_JUMP) return 0;
+
+    IRInstruction *branch = &out[count - 1];
+    if ((branch->opcode != IR_JUMP_IF_FALSE && branch->opcode != IR_JUMP_IF_TRUE) ||
+        branch->operand.target != index + 1) {
+        return 0;
+    }
+
+    branch->opcode = branch->opcode == IR_JUMP_IF_FALSE ? IR_JUMP_IF_TRUE : IR_JUMP_IF_FALSE;
+    branch->operand.target = jump->operand.target;
+    return 1;
+}
+
+/**
+ * Points jumps that land on an unconditional jump straight at its destination.
+ * 
+ * Loops and breaks often jump to a jump (a loop whose condition folded to
+ * true ends in one), which costs an extra dispatch on every pass. No
+ * instructions are removed; the skipped jumps may become unreachable.
+ * 
+ * @param code The IR code to rewrite in place
+ * @return The number of jumps retargeted
+ */
+int thread_jumps(IRCode *code) {
+    int threaded = 0;
+    for (int i = 0; i < code->count; i++) {
+        IRInstruction *instr = &code->instructions[i];
+        if (!ir_is_jump(instr->opcode)) continue;
+
+        // The hop limit stops on a loop made only of jumps
+        int target = instr->operand.target;
+        for (int hops = 0; hops < code->count && target >= 0 && target < code->count &&
+                           code->instructions[target].opcode == IR_JUMP; hops++) {
+            target = code->instructions[target].operand.target;
+        }
+        if (target != instr->operand.target) {
+            instr->operand.target = target;
+            threaded++;
+        }
+    }
+    return threaded;
+}
+
+/**
+ * Folds constant subexpressions and removes algebraic identities.
+ * 
+ * Rewrites the code in a single forward pass: each instruction is appended
+ * to the output and the tail is simplified for as long as a rule applies, so
+ * nested constant expressions such as (5 + 3) * 2 collapse to one
+ * PUSH_CONST. Runtime errors are preserved: operations the VM would reject
+ * are never folded, and identities only drop constants, never the
+ * expression they apply to. Branches on a constant condition become a plain
+ * jump or disappear, and a branch over a jump becomes the inverted branch.
+ * 
+ * @param code The IR code to optimize in place
+ * @return The number of instructions removed
+ */
+int fold_constants(IRCode *code) {
+    int before = code->count;
+    int *map;
+    unsigned char *is_target;
+    if (!begin_jump_remap(code, &map, &is_target)) return 0;
+
+    int n = 0;
+    int barrier = 0;  // Rewrites never reach below the latest jump target
+
+    for (int i = 0; i < code->count; i++) {
+        if (map) map[i] = n;
+        if (is_target && is_target[i]) barrier = n;
+
+        if (n > barrier && merge_branch_over_jump(code->instructions, n, &code->instructions[i], i)) {
+            continue;
+        }
+
+        code->instructions[n++] = code->instructions[i];
+        int tail = n - barrier;
+        while (simplify_tail(code->instructions + barrier, &tail, code->strings) ||
+               simplify_left_identity(code->instructions + barrier, &tail)) {
+            // keep simplifying until the tail is stable
+        }
+        n = barrier + tail;
+    }
+
+    code->count = n;
+    end_jump_remap(code, before, map, is_target);
+    return before - n;
+}
+
+/**
+ * Tries to fuse the instructions at the end of a partially rewritten code array
+ * into a superinstruction.
+ * 
+ * Recognized sequences:
+ *   PUSH_VAR s; PUSH_CONST k; ADD        -> ADD_VAR_CONST s, k   (also k + s, s - k)
+ *   ADD_VAR_CONST s, k; STORE_VAR s      -> INC_VAR s, k
+ *   PUSH_VAR a; PUSH_VAR b; EQ/NE/LT/LE  -> <cmp>_VAR_VAR a, b
+ *   PUSH_VAR a; PUSH_VAR b; GT/GE        -> LT/LE_VAR_VAR b, a
+ * 
+ * @param out The rewritten instructions
+ * @param count Pointer to the number of rewritten instructions, updated on success
+ * @return 1 if a rewrite happened, 0 otherwise
+ */
+int fuse_tail(IRInstruction *out, int *count) {
+    int n = *count;
+    if (n < 2) return 0;
+
+    IRInstruction *op = &out[n - 1];
+
+    if (op->opcode == IR_STORE_VAR && out[n - 2].opcode == IR_ADD_VAR_CONST &&
+        out[n - 2].operand.var_const.slot == op->operand.slot) {
+        out[n - 2].opcode = IR_INC_VAR;
+        *count = n - 1;
+        return 1;
+    }
+
+    if (n < 3) return 0;
+    IRInstruction *left = &out[n - 3];
+    IRInstruction *right = &out[n - 2];
+
+    if (op->opcode == IR_ADD || op->opcode == IR_SUB) {
+        int slot, value;
+        if (left->opcode == IR_PUSH_VAR && right->opcode == IR_PUSH_CONST) {
+            slot = left->operand.slot;
+            value = right->operand.int_value;
+            if (op->opcode == IR_SUB) {
+                value = (int)(0u - (unsigned int)value);
+            }
+        } else if (op->opcode == IR_ADD && left->opcode == IR_PUSH_CONST && right->opcode == IR_PUSH_VAR) {
+            slot = right->operand.slot;
+            value = left->operand.int_value;
+        } else {
+            return 0;
+        }
+        left->opcode = IR_ADD_VAR_CONST;
+        left->operand.var_const.slot = slot;
+        left->operand.var_const.value = value;
+        *count = n - 2;
+        return 1;
+    }
+
+    if (left->opcode != IR_PUSH_VAR || right->opcode != IR_PUSH_VAR) return 0;
+
+    int a = left->operand.slot;
+    int b = right->operand.slot;
+    IROpcode fused;
+    switch (op->opcode) {
+        case IR_EQ: fused = IR_EQ_VAR_VAR; break;
+        case IR_NE: fused = IR_NE_VAR_VAR; break;
+        case IR_LT: fused = IR_LT_VAR_VAR; break;
+        case IR_LE: fused = IR_LE_VAR_VAR; break;
+        case IR_GT: fused = IR_LT_VAR_VAR; a = right->operand.slot; b = left->operand.slot; break;
+        case IR_GE: fused = IR_LE_VAR_VAR; a = right->operand.slot; b = left->operand.slot; break;
+        default:    return 0;
+    }
+    left->opcode = fused;
+    left->operand.var_pair.left = a;
+    left->operand.var_pair.right = b;
+    *count = n - 2;
+    return 1;
+}
+
+/**
+ * Fuses common instruction sequences into superinstructions.
+ * 
+ * Works like fold_constants: instructions are appended one at a time and
+ * the tail is fused while a pattern matches, so PUSH_VAR; PUSH_CONST; ADD;
+ * STORE_VAR collapses in two steps to a single INC_VAR. Every fused
+ * instruction does the same work as the sequence it replaces in one
+ * dispatch. Run it after fold_constants, which only understands the basic
+ * instruction set.
+ * 
+ * @param code The IR code to optimize in place
+ * @return The number of instructions removed
+ */
+int fuse_superinstructions(IRCode *code) {
+    int before = code->count;
+    int *map;
+    unsigned char *is_target;
+    if (!begin_jump_remap(code, &map, &is_target)) return 0;
+
+    int n = 0;
+    int barrier = 0;  // Fusion never reaches below the latest jump target
+
+    for (int i = 0; i < code->count; i++) {
+        if (map) map[i] = n;
+        if (is_target && is_target[i]) barrier = n;
+
+        code->instructions[n++] = code->instructions[i];
+        int tail = n - barrier;
+        while (fuse_tail(code->instructions + barrier, &tail)) {
+            // keep fusing until the tail is stable
+        }
+        n = barrier + tail;
+    }
+
+    code->count = n;
+    end_jump_remap(code, before, map, is_target);
+    return before - n;
+}
+
+/**
+ * Runs the IR optimization passes selected by an optimization level.
+ * 
+ * -O0 leaves the code untouched, -O1 folds constants, simplifies
+ * algebraic identities and threads jumps, -O2 additionally fuses common sequences into
+ * superinstructions.
+ * 
+ * @param code The IR code to optimize in place
+ * @param level The optimization level (0 disables all passes)
+ */
+void optimize_ir(IRCode *code, int level) {
+    if (level >= 1) {
+        fold_constants(code);
+        thread_jumps(code);
+    }
+    if (level >= 2) {
+        fuse_superinstructions(code);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef SPADE_OPT_H
+#define SPADE_OPT_H
+
+#include "spade.ir.h"
+
+int ir_operand_start(IRInstruction *instructions, int end);
+int begin_jump_remap(IRCode *code, int **map, unsigned char **is_target);
+void end_jump_remap(IRCode *code, int old_count, int *map, unsigned char *is_target);
+int fold_constants(IRCode *code);
+int thread_jumps(IRCode *code);
+int fuse_superinstructions(IRCode *code);
+void optimize_ir(IRCode *code, int level);
+
+#endif
@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include "spade.output.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SPADE_THREAD_LOCAL __declspec(thread)
+#else
+#define SPADE_THREAD_LOCAL _Thread_local
+#endif
+
+SPADE_THREAD_LOCAL FILE *thread_output = NULL;  // NULL means stdout
+
+/**
+ * Returns the stream the calling thread prints to.
+ *
+ * @return The thread's output stream, or stdout if none has been set
+ */
+FILE *spade_stdout(void) {
+    return thread_output ? thread_output : stdout;
+}
+
+/**
+ * Redirects the calling thread's output.
+ *
+ * @param stream The stream to print to, or NULL to print to stdout
+ */
+void set_thread_output(FILE *stream) {
+    thread_output = stream;
+}
+
+/**
+ * printf to the calling thread's output stream.
+ *
+ * @param format A printf format string
+ * @return The number of characters written, or a negative value on error
+ */
+int spade_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vfprintf(spade_stdout(), format, args);
+    va_end(args);
+    return written;
+}
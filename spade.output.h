@@ -0,0 +1,37 @@
+#ifndef SPADE_OUTPUT_H
+#define SPADE_OUTPUT_H
+
+#include <stdio.h>
+
+/**
+ * Output routing for compiler diagnostics and debug dumps.
+ *
+ * Everything the pipeline prints goes through spade_printf and spade_stdout
+ * rather than to stdout directly. Each thread can redirect its own output
+ * with set_thread_output, which lets parallel (-j) compilation capture every
+ * job's output separately and print it in input order.
+ */
+
+/**
+ * Returns the stream the calling thread prints to.
+ *
+ * @return The thread's output stream, or stdout if none has been set
+ */
+FILE *spade_stdout(void);
+
+/**
+ * Redirects the calling thread's output.
+ *
+ * @param stream The stream to print to, or NULL to print to stdout
+ */
+void set_thread_output(FILE *stream);
+
+/**
+ * printf to the calling thread's output stream.
+ *
+ * @param format A printf format string
+ * @return The number of characters written, or a negative value on error
+ */
+int spade_printf(const char *format, ...);
+
+#endif
@@ -4,9 +4,7 @@
 #include "spade.lexer.h"
 #include "spade.parser.h"
 #include "spade.symbol.h"
-
-
-SymbolTable global_symbol_table = {0};
+#include "spade.output.h"
 
 
 const char *ast_type_strings[] = {
@@ -25,11 +23,68 @@ const char *ast_type_strings[] = {
     "AST_STRING_LITERAL",
     "AST_BINARY_OPERATION",
     "AST_UNARY_OPERATION",
+    "AST_BLOCK",
+    "AST_IF",
+    "AST_WHILE",
+    "AST_FOR",
+    "AST_BREAK",
+    "AST_CONTINUE",
     "AST_NULL"
 };
 
 // Helper functions
 
+/**
+ * Initializes a parser that reads tokens from a lexer.
+ * 
+ * @param parser The parser to initialize
+ * @param lexer The token stream to parse
+ */
+void init_parser(Parser *parser, Lexer *lexer) {
+    parser->lexer = lexer;
+    parser->current = 0;
+    parser->lexed = 0;
+    init_arena(&parser->arena);
+}
+
+/**
+ * Frees everything the parser allocated, including every AST it produced.
+ * 
+ * @param parser The parser to free; its ASTs must no longer be in use
+ */
+void free_parser(Parser *parser) {
+    free_arena(&parser->arena);
+}
+
+/**
+ * Returns the token at a stream position, pulling tokens from the lexer as needed.
+ * 
+ * Only positions inside the window (from current - 1 to current + 1) may be
+ * requested.
+ * 
+ * @param parser The parser instance
+ * @param position The stream position of the token
+ * @return The token at that position
+ */
+Token token_at(Parser *parser, int position) {
+    while (parser->lexed <= position) {
+        parser->window[parser->lexed % PARSER_WINDOW] = next_token(parser->lexer);
+        parser->lexed++;
+    }
+    return parser->window[position % PARSER_WINDOW];
+}
+
+/**
+ * Copies a token's text into the parser's arena as a NUL-terminated string.
+ * 
+ * @param parser The parser instance
+ * @param token The token to copy
+ * @return The copy, valid until free_parser
+ */
+char *copy_token_string(Parser *parser, Token token) {
+    return arena_strndup(&parser->arena, token.start, token.length);
+}
+
 /**
  * Gets the current token from the parser without advancing.
  * 
@@ -37,11 +92,34 @@ const char *ast_type_strings[] = {
  * @return The current token, or an EOF token if at the end
  */
 Token current_token(Parser *parser) {
-    if (parser->current < parser->token_count) {
-        return parser->tokens[parser->current];
+    return token_at(parser, parser->current);
+}
+
+/**
+ * Gets the token after the current one without advancing.
+ * 
+ * @param parser The parser instance
+ * @return The next token, or an EOF token if at the end
+ */
+Token peek_token(Parser *parser) {
+    return token_at(parser, parser->current + 1);
+}
+
+/**
+ * Converts a number token's digits to an int.
+ * 
+ * Tokens are not NUL-terminated, so the digits are read from the span
+ * directly instead of with atoi.
+ * 
+ * @param token A TOKEN_NUMBER token
+ * @return The token's value
+ */
+int token_number(Token token) {
+    unsigned int value = 0;
+    for (int i = 0; i < token.length; i++) {
+        value = value * 10 + (unsigned int)(token.start[i] - '0');
     }
-    Token eof = {-1, NULL};  // End of file token
-    return eof;
+    return (int)value;
 }
 
 /**
@@ -50,7 +128,7 @@ Token current_token(Parser *parser) {
  * @param parser The parser instance to advance
  */
 void advance(Parser *parser) {
-    if (parser->current < parser->token_count) {
+    if (current_token(parser).type != TOKEN_EOF) {
         parser->current++;
     }
 }
@@ -62,7 +140,7 @@ void advance(Parser *parser) {
  * @return The token at the previous position
  */
 Token previous_token(Parser *parser) {
-    return parser->tokens[parser->current - 1];
+    return token_at(parser, parser->current - 1);
 }
 
 
@@ -94,144 +172,6 @@ int is_data_type_token(enum TokenType type) {
             type == TOKEN_FLOAT || type == TOKEN_DOUBLE || 
             type == TOKEN_LONG);
 }
-/**
- * Recursively frees memory allocated for an Abstract Syntax Tree node and its children.
- * 
- * @param node The AST node to be freed
- */
-void free_AST(ASTNode *node) {
-    if (node == NULL) {
-        return;
-    }else{
-        switch(node->type){
-            case AST_PROGRAM: {
-                for(int i = 0; i < node->data.program.statement_count; i++){
-                    free_AST(node->data.program.statements[i]);
-                }
-                free(node->data.program.statements);
-                break;
-            }
-            
-            case AST_VARIABLE_DECLARATION:
-                if(node->data.var_declaration.name != NULL){
-                    free(node->data.var_declaration.name);
-                }
-
-                if(node->data.var_declaration.value != NULL){
-                    free_AST(node->data.var_declaration.value);
-                }
-                break;
-            case AST_IDENTIFIER: {
-                if(node->data.identifier.name != NULL){
-                    free(node->data.identifier.name);
-                }
-                break;
-            }
-
-            case AST_STRING_LITERAL: {
-                if(node->data.string_lit.value != NULL){
-                    free(node->data.string_lit.value);
-                }
-                break;
-            }
-
-            case AST_NUMBER: break;
-
-            case AST_BOOLEAN: break;
-
-            case AST_BINARY_OPERATION: {
-                if(node->data.bin_op.left != NULL){
-                    free_AST(node->data.bin_op.left);
-                }
-
-                if(node->data.bin_op.right != NULL){
-                    free_AST(node->data.bin_op.right);
-                }
-
-                break;
-            }
-
-            case AST_UNARY_OPERATION: {
-                if(node->data.unary_op.operand != NULL){
-                    free_AST(node->data.unary_op.operand);
-                }
-                break;
-            }
-
-            case AST_FUNCTION_DECLARATION: {
-                if(node->data.function_declaration.name != NULL){
-                    free(node->data.function_declaration.name);
-                }
-                if(node->data.function_declaration.parameters != NULL){
-                    free_AST(node->data.function_declaration.parameters);
-                }
-                if(node->data.function_declaration.body != NULL){
-                    free_AST(node->data.function_declaration.body);
-                }
-                break;
-            }
-
-            case AST_PARAMETER_LIST: {
-                for(int i = 0; i < node->data.parameter_list.parameter_count; i++){
-                    free_AST(node->data.parameter_list.parameters[i]);
-                }
-                free(node->data.parameter_list.parameters);
-                break;
-            }
-
-            case AST_PARAMETER: {
-                if(node->data.parameter.name != NULL){
-                    free(node->data.parameter.name);
-                }
-                break;
-            }
-
-            case AST_FUNCTION_CALL: {
-                if(node->data.function_call.name != NULL){
-                    free(node->data.function_call.name);
-                }
-                if(node->data.function_call.arguments != NULL){
-                    free_AST(node->data.function_call.arguments);
-                }
-                break;
-            }
-
-            case AST_ARGUMENT_LIST: {
-                for(int i = 0; i < node->data.argument_list.argument_count; i++){
-                    free_AST(node->data.argument_list.arguments[i]);
-                }
-                free(node->data.argument_list.arguments);
-                break;
-            }
-
-            case AST_ARGUMENT: {
-                if(node->data.argument.value != NULL){
-                    free_AST(node->data.argument.value);
-                }
-                break;
-            }
-
-            case AST_ASSIGNMENT: {
-                if(node->data.variable_assignment.name != NULL){
-                    free(node->data.variable_assignment.name);
-                }
-                if(node->data.variable_assignment.value != NULL){
-                    free_AST(node->data.variable_assignment.value);
-                }
-                break;
-            }
-
-            case AST_NULL: break;
-
-            default:
-                printf("Unable to free AST node - Unknown AST node type - %s\n", ast_type_strings[node->type]);
-            
-        }
-
-        free(node);
-    }
-}
-
 /**
  * Recursively prints an Abstract Syntax Tree for debugging purposes.
  * 
@@ -242,53 +182,53 @@ void print_AST(ASTNode *node, int indent) {
     if (!node) return;
     
     // Print indentation
-    for (int i = 0; i < indent; i++) printf("  ");
+    for (int i = 0; i < indent; i++) spade_printf("  ");
     
     switch (node->type) {
         case AST_PROGRAM:
-            printf("PROGRAM: %d statements\n", node->data.program.statement_count);
+            spade_printf("PROGRAM: %d statements\n", node->data.program.statement_count);
             for (int i = 0; i < node->data.program.statement_count; i++) {
                 print_AST(node->data.program.statements[i], indent + 1);
             }
             break;
             
         case AST_VARIABLE_DECLARATION:
-            printf("VAR_DECL: type=%s, name='%s'\n", 
+            spade_printf("VAR_DECL: type=%s, name='%s'\n", 
                    get_token_name(node->data.var_declaration.var_type),
                    node->data.var_declaration.name);
             if (node->data.var_declaration.value) {
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("value:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("value:\n");
                 print_AST(node->data.var_declaration.value, indent + 2);
             }
             break;
             
         case AST_NUMBER:
-            printf("NUMBER: %d\n", node->data.number.value);
+            spade_printf("NUMBER: %d\n", node->data.number.value);
             break;
             
         case AST_IDENTIFIER:
-            printf("IDENTIFIER: '%s'\n", node->data.identifier.name);
+            spade_printf("IDENTIFIER: '%s'\n", node->data.identifier.name);
             break;
 
         case AST_STRING_LITERAL:
-            printf("STRING_LITERAL: '%s'\n", node->data.string_lit.value);
+            spade_printf("STRING_LITERAL: '%s'\n", node->data.string_lit.value);
             break;
             
         case AST_BOOLEAN:
-            printf("BOOLEAN: %s\n", node->data.boolean.value ? "true" : "false");
+            spade_printf("BOOLEAN: %s\n", node->data.boolean.value ? "true" : "false");
             break;
 
         case AST_BINARY_OPERATION: {
-            printf("BINARY_OPERATION: op=%s\n", get_token_name(node->data.bin_op.op));
+            spade_printf("BINARY_OPERATION: op=%s\n", get_token_name(node->data.bin_op.op));
             if(node->data.bin_op.left){
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("left:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("left:\n");
                 print_AST(node->data.bin_op.left, indent + 2);
             }
             if(node->data.bin_op.right){
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("right:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("right:\n");
                 print_AST(node->data.bin_op.right, indent + 2);
             }
             break;
@@ -296,84 +236,146 @@ void print_AST(ASTNode *node, int indent) {
         }
 
         case AST_UNARY_OPERATION: {
-            printf("UNARY_OPERATION: op=%s\n", get_token_name(node->data.unary_op.op));
+            spade_printf("UNARY_OPERATION: op=%s\n", get_token_name(node->data.unary_op.op));
             if(node->data.unary_op.operand){
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("operand:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("operand:\n");
                 print_AST(node->data.unary_op.operand, indent + 2);
             }
             break;
         }
             
         case AST_FUNCTION_DECLARATION:
-            printf("FUNCTION_DECL: type=%s, name='%s'\n", 
+            spade_printf("FUNCTION_DECL: type=%s, name='%s'\n", 
                    get_token_name(node->data.function_declaration.return_type),
                    node->data.function_declaration.name);
             if (node->data.function_declaration.parameters) {
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("parameters:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("parameters:\n");
                 print_AST(node->data.function_declaration.parameters, indent + 2);
             }
             if (node->data.function_declaration.body) {
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("body:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("body:\n");
                 print_AST(node->data.function_declaration.body, indent + 2);
             }
             break;
 
         case AST_PARAMETER_LIST:
-            printf("PARAMETER_LIST: %d parameters\n", node->data.parameter_list.parameter_count);
+            spade_printf("PARAMETER_LIST: %d parameters\n", node->data.parameter_list.parameter_count);
             for (int i = 0; i < node->data.parameter_list.parameter_count; i++) {
                 print_AST(node->data.parameter_list.parameters[i], indent + 1);
             }
             break;
 
         case AST_PARAMETER:
-            printf("PARAMETER: type=%s, name='%s'\n", 
+            spade_printf("PARAMETER: type=%s, name='%s'\n", 
                    get_token_name(node->data.parameter.type),
                    node->data.parameter.name);
             break;
 
         case AST_FUNCTION_CALL:
-            printf("FUNCTION_CALL: name='%s'\n", node->data.function_call.name);
+            spade_printf("FUNCTION_CALL: name='%s'\n", node->data.function_call.name);
             if (node->data.function_call.arguments) {
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("arguments:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("arguments:\n");
                 print_AST(node->data.function_call.arguments, indent + 2);
             }
             break;
 
         case AST_ARGUMENT_LIST:
-            printf("ARGUMENT_LIST: %d arguments\n", node->data.argument_list.argument_count);
+            spade_printf("ARGUMENT_LIST: %d arguments\n", node->data.argument_list.argument_count);
             for (int i = 0; i < node->data.argument_list.argument_count; i++) {
                 print_AST(node->data.argument_list.arguments[i], indent + 1);
             }
             break;
 
         case AST_ARGUMENT:
-            printf("ARGUMENT:\n");
+            spade_printf("ARGUMENT:\n");
             if (node->data.argument.value) {
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("value:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("value:\n");
                 print_AST(node->data.argument.value, indent + 2);
             }
             break;
 
         case AST_ASSIGNMENT:
-            printf("ASSIGNMENT: name='%s'\n", node->data.variable_assignment.name);
+            spade_printf("ASSIGNMENT: name='%s'\n", node->data.variable_assignment.name);
             if (node->data.variable_assignment.value) {
-                for (int i = 0; i < indent + 1; i++) printf("  ");
-                printf("value:\n");
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("value:\n");
                 print_AST(node->data.variable_assignment.value, indent + 2);
             }
             break;
 
+        case AST_BLOCK:
+            spade_printf("BLOCK: %d statements\n", node->data.block.statement_count);
+            for (int i = 0; i < node->data.block.statement_count; i++) {
+                print_AST(node->data.block.statements[i], indent + 1);
+            }
+            break;
+
+        case AST_IF:
+            spade_printf("IF:\n");
+            for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+            spade_printf("condition:\n");
+            print_AST(node->data.if_statement.condition, indent + 2);
+            for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+            spade_printf("then:\n");
+            print_AST(node->data.if_statement.then_branch, indent + 2);
+            if (node->data.if_statement.else_branch) {
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("else:\n");
+                print_AST(node->data.if_statement.else_branch, indent + 2);
+            }
+            break;
+
+        case AST_WHILE:
+            spade_printf("WHILE:\n");
+            for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+            spade_printf("condition:\n");
+            print_AST(node->data.while_loop.condition, indent + 2);
+            for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+            spade_printf("body:\n");
+            print_AST(node->data.while_loop.body, indent + 2);
+            break;
+
+        case AST_FOR:
+            spade_printf("FOR:\n");
+            if (node->data.for_loop.initializer) {
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("initializer:\n");
+                print_AST(node->data.for_loop.initializer, indent + 2);
+            }
+            if (node->data.for_loop.condition) {
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("condition:\n");
+                print_AST(node->data.for_loop.condition, indent + 2);
+            }
+            if (node->data.for_loop.update) {
+                for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+                spade_printf("update:\n");
+                print_AST(node->data.for_loop.update, indent + 2);
+            }
+            for (int i = 0; i < indent + 1; i++) spade_printf("  ");
+            spade_printf("body:\n");
+            print_AST(node->data.for_loop.body, indent + 2);
+            break;
+
+        case AST_BREAK:
+            spade_printf("BREAK\n");
+            break;
+
+        case AST_CONTINUE:
+            spade_printf("CONTINUE\n");
+            break;
+
         case AST_NULL:
-            printf("NULL\n");
+            spade_printf("NULL\n");
             break;
             
         default:
-            printf("UNKNOWN NODE TYPE: %d\n", node->type);
+            spade_printf("UNKNOWN NODE TYPE: %d\n", node->type);
     }
 }
 
@@ -403,30 +405,35 @@ parse_primary (numbers, identifiers, parentheses)
  * @return An AST node representing the complete program, or NULL on error
  */
 ASTNode *parse_program(Parser *parser) {
-    ASTNode *program = malloc(sizeof(ASTNode));
+    ASTNode *program = arena_alloc(&parser->arena, sizeof(ASTNode));
     program->type = AST_PROGRAM;
     program->data.program.capacity = 10;
     program->data.program.statement_count = 0;
-    program->data.program.statements = malloc(sizeof(ASTNode*) * program->data.program.capacity);
+    program->data.program.statements = arena_alloc(&parser->arena, sizeof(ASTNode *) * program->data.program.capacity);
     
     // Parse statements until end of file
-    while (current_token(parser).type != -1) {  // -1 is EOF token
+    while (current_token(parser).type != TOKEN_EOF) {
         ASTNode *stmt = parse_statement(parser);
         if (!stmt) {
-            printf("Error parsing statement\n");
-            free_AST(program);
+            spade_printf("Error parsing statement\n");
             return NULL;
         }
         
         // Resize array if needed
         if (program->data.program.statement_count >= program->data.program.capacity) {
+            program->data.program.statements = arena_grow(&parser->arena, program->data.program.statements,
+                sizeof(ASTNode *) * program->data.program.capacity,
+                sizeof(ASTNode *) * program->data.program.capacity * 2);
             program->data.program.capacity *= 2;
-            program->data.program.statements = realloc(program->data.program.statements, 
-                sizeof(ASTNode*) * program->data.program.capacity);
         }
         
         program->data.program.statements[program->data.program.statement_count++] = stmt;
     }
+
+    // A lexical error ends the token stream early, so what was parsed is incomplete
+    if (parser->lexer->error) {
+        return NULL;
+    }
     
     return program;
 }
@@ -435,8 +442,9 @@ ASTNode *parse_program(Parser *parser) {
  * Determines the type of statement and delegates to the appropriate parser.
  * 
  * Analyzes the current token to determine what kind of statement is being parsed
- * and calls the corresponding parsing function. Currently supports variable
- * declarations, with framework for adding more statement types.
+ * and calls the corresponding parsing function: variable and function
+ * declarations, assignments, blocks, if/else, while and for loops, and
+ * break/continue.
  * 
  * @param parser The parser instance
  * @return An AST node representing the parsed statement, or NULL on error
@@ -446,29 +454,34 @@ ASTNode *parse_statement(Parser *parser) {
     
     // Variable declaration: int, bool, string, etc.
     if (is_data_type_token(token.type)) {
-        Token next_token = parser->tokens[parser->current + 1];
-        if(next_token.type == TOKEN_IDENTIFIER){
+        Token next = peek_token(parser);
+        if(next.type == TOKEN_IDENTIFIER){
             return parse_variable_declaration(parser);
-        }else if(next_token.type == TOKEN_TASK){
+        }else if(next.type == TOKEN_TASK){
             return parse_function_declaration(parser);
         }
     }
 
     if(token.type == TOKEN_IDENTIFIER){
         // check for variable reassignment
-        Token next_token = parser->tokens[parser->current + 1];
-        if(next_token.type == TOKEN_ASSIGN){
+        Token next = peek_token(parser);
+        if(next.type == TOKEN_ASSIGN){
             return parse_assignment(parser);
         }
         
     }
     
-    // Future: Add more statement types
-    // if (token.type == TOKEN_IF) return parse_if_statement(parser);
-    // if (token.type == TOKEN_WHILE) return parse_while_statement(parser);
-    // if (token.type == TOKEN_IDENTIFIER) return parse_assignment_or_call(parser);
-    
-    printf("Error: Unknown statement starting with %s\n", token.value);
+    switch(token.type){
+        case TOKEN_LBRACE:   return parse_block(parser);
+        case TOKEN_IF:       return parse_if_statement(parser);
+        case TOKEN_WHILE:    return parse_while_statement(parser);
+        case TOKEN_FOR:      return parse_for_statement(parser);
+        case TOKEN_BREAK:
+        case TOKEN_CONTINUE: return parse_loop_control(parser);
+        default:             break;
+    }
+
+    spade_printf("Error: Unknown statement starting with %.*s\n", token.length, token.start);
     return NULL;
 }
 
@@ -493,10 +506,9 @@ ASTNode *parse_logical_or(Parser *parser){
         enum TokenType operator = previous_token(parser).type;
         ASTNode *right = parse_logical_and(parser);
         if(!right){
-            free_AST(left);
             return NULL;
         }
-        ASTNode *bin_node = malloc(sizeof(ASTNode));
+        ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
         bin_node->type = AST_BINARY_OPERATION;
         bin_node->data.bin_op.op = operator;
         bin_node->data.bin_op.left = left;
@@ -518,10 +530,9 @@ ASTNode *parse_logical_and(Parser *parser){
         enum TokenType operator = previous_token(parser).type;
         ASTNode *right = parse_equality(parser);
         if(!right){
-            free_AST(left);
             return NULL;
         }
-        ASTNode *bin_node = malloc(sizeof(ASTNode));
+        ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
         bin_node->type = AST_BINARY_OPERATION;
         bin_node->data.bin_op.op = operator;
         bin_node->data.bin_op.left = left;
@@ -543,10 +554,9 @@ ASTNode *parse_equality(Parser *parser){
         enum TokenType operator = previous_token(parser).type;
         ASTNode *right = parse_comparison(parser);
         if(!right){
-            free_AST(left);
             return NULL;
         }
-        ASTNode *bin_node = malloc(sizeof(ASTNode));
+        ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
         bin_node->type = AST_BINARY_OPERATION;
         bin_node->data.bin_op.op = operator;
         bin_node->data.bin_op.left = left;
@@ -572,11 +582,10 @@ ASTNode *parse_comparison(Parser *parser){
         enum TokenType operator = previous_token(parser).type;
         ASTNode *right = parse_term(parser);
         if(!right){
-            free_AST(left);
             return NULL;
         }
 
-        ASTNode *bin_node = malloc(sizeof(ASTNode));
+        ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
         bin_node->type = AST_BINARY_OPERATION;
         bin_node->data.bin_op.op = operator;
         bin_node->data.bin_op.left = left;
@@ -598,11 +607,10 @@ ASTNode *parse_term(Parser *parser){
         enum TokenType operator = previous_token(parser).type;
         ASTNode *right = parse_factor(parser);
         if(!right){
-            free_AST(left);
             return NULL;
         }
 
-        ASTNode *bin_node = malloc(sizeof(ASTNode));
+        ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
         bin_node->type = AST_BINARY_OPERATION;
         bin_node->data.bin_op.op = operator;
         bin_node->data.bin_op.left = left;
@@ -625,11 +633,10 @@ ASTNode *parse_factor(Parser *parser){
             enum TokenType operator = previous_token(parser).type;
             ASTNode *right = parse_factor(parser);
             if(!right){
-                free_AST(left);
                 return NULL;
             }
     
-            ASTNode *bin_node = malloc(sizeof(ASTNode));
+            ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
             bin_node->type = AST_BINARY_OPERATION;
             bin_node->data.bin_op.op = operator;
             bin_node->data.bin_op.left = left;
@@ -640,12 +647,11 @@ ASTNode *parse_factor(Parser *parser){
             enum TokenType operator = previous_token(parser).type;
             ASTNode *right = parse_primary(parser);
             if(!right){
-                free_AST(left);
                 return NULL;
             }
 
 
-            ASTNode *bin_node = malloc(sizeof(ASTNode));
+            ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
             bin_node->type = AST_BINARY_OPERATION;
             bin_node->data.bin_op.op = operator;
             bin_node->data.bin_op.left = left;
@@ -669,11 +675,10 @@ ASTNode *parse_exponent(Parser *parser){
         enum TokenType operator = previous_token(parser).type;
         ASTNode *right = parse_exponent(parser);
         if(!right){
-            free_AST(left);
             return NULL;
         }
 
-        ASTNode *bin_node = malloc(sizeof(ASTNode));
+        ASTNode *bin_node = arena_alloc(&parser->arena, sizeof(ASTNode));
         bin_node->type = AST_BINARY_OPERATION;
         bin_node->data.bin_op.op = operator;
         bin_node->data.bin_op.left = left;
@@ -693,7 +698,7 @@ ASTNode *parse_unary(Parser *parser){
         if(!operand){
             return NULL;
         }
-        ASTNode *unary_node = malloc(sizeof(ASTNode));
+        ASTNode *unary_node = arena_alloc(&parser->arena, sizeof(ASTNode));
         unary_node->type = AST_UNARY_OPERATION;
         unary_node->data.unary_op.op = operator;
         unary_node->data.unary_op.operand = operand;
@@ -718,39 +723,39 @@ ASTNode *parse_primary(Parser *parser){
 
     switch(current_token(parser).type){
         case TOKEN_NUMBER: {
-            ASTNode *node = malloc(sizeof(ASTNode));
+            ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
             node->type = AST_NUMBER;
-            node->data.number.value = atoi(current_token(parser).value);
+            node->data.number.value = token_number(current_token(parser));
             advance(parser);
             return node;
         }
 
         case TOKEN_IDENTIFIER: {
             // Look ahead to distinguish between identifier and function call
-            Token next = parser->tokens[parser->current + 1];
+            Token next = peek_token(parser);
 
             // Check for function call pattern: identifier followed by '('
             if(next.type != TOKEN_LPAREN){
                 // Simple identifier (variable reference)
-                ASTNode *node = malloc(sizeof(ASTNode));
+                ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
                 node->type = AST_IDENTIFIER;
-                node->data.identifier.name = strdup(current_token(parser).value);
+                node->data.identifier.name = copy_token_string(parser, current_token(parser));
                 advance(parser);
                 return node;
             }
 
             // Function call: identifier(arguments)
-            ASTNode *node = malloc(sizeof(ASTNode));
+            ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
             node->type = AST_FUNCTION_CALL;
-            node->data.function_call.name = strdup(current_token(parser).value);  // Store function name
+            node->data.function_call.name = copy_token_string(parser, current_token(parser));  // Store function name
             advance(parser);    // Move past function name to '('
             
             // Create argument list container
-            ASTNode *arg_list = malloc(sizeof(ASTNode));
+            ASTNode *arg_list = arena_alloc(&parser->arena, sizeof(ASTNode));
             arg_list->type = AST_ARGUMENT_LIST;
             arg_list->data.argument_list.argument_count = 0;
             arg_list->data.argument_list.capacity = 10;
-            arg_list->data.argument_list.arguments = malloc(sizeof(ASTNode *) * arg_list->data.argument_list.capacity);
+            arg_list->data.argument_list.arguments = arena_alloc(&parser->arena, sizeof(ASTNode *) * arg_list->data.argument_list.capacity);
             advance(parser);    // Move past '(' to first argument
 
             // Parse arguments until closing parenthesis
@@ -761,16 +766,17 @@ ASTNode *parse_primary(Parser *parser){
                 }
                 
                 // Parse each argument as an expression
-                ASTNode *arg = malloc(sizeof(ASTNode));
+                ASTNode *arg = arena_alloc(&parser->arena, sizeof(ASTNode));
                 arg->type = AST_ARGUMENT;
                 arg->data.argument.value = parse_expression(parser);  // Parse argument expression
                 
                 // Add argument to list, expanding capacity if needed
                 arg_list->data.argument_list.arguments[arg_list->data.argument_list.argument_count++] = arg;
                 if(arg_list->data.argument_list.argument_count >= arg_list->data.argument_list.capacity - 1){
+                    arg_list->data.argument_list.arguments = arena_grow(&parser->arena, arg_list->data.argument_list.arguments,
+                        arg_list->data.argument_list.capacity * sizeof(ASTNode *),
+                        arg_list->data.argument_list.capacity * 2 * sizeof(ASTNode *));
                     arg_list->data.argument_list.capacity *= 2;
-                    arg_list->data.argument_list.arguments = realloc(arg_list->data.argument_list.arguments, 
-                        arg_list->data.argument_list.capacity * sizeof(ASTNode *));
                 }
             }
 
@@ -780,15 +786,17 @@ ASTNode *parse_primary(Parser *parser){
         }
 
         case TOKEN_STRING_LITERAL: {
-            ASTNode *node = malloc(sizeof(ASTNode));
+            ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
             node->type = AST_STRING_LITERAL;
-            node->data.string_lit.value = strdup(current_token(parser).value);
+            Token token = current_token(parser);
+            node->data.string_lit.length = token.length;
+            node->data.string_lit.value = copy_token_string(parser, token);
             advance(parser);
             return node;
         }
 
         case TOKEN_TRUE: {
-            ASTNode *node = malloc(sizeof(ASTNode));
+            ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
             node->type = AST_BOOLEAN;
             node->data.boolean.value = 1;
             advance(parser);
@@ -796,7 +804,7 @@ ASTNode *parse_primary(Parser *parser){
         }
 
         case TOKEN_FALSE: {
-            ASTNode *node = malloc(sizeof(ASTNode));
+            ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
             node->type = AST_BOOLEAN;
             node->data.boolean.value = 0;
             advance(parser);
@@ -810,15 +818,14 @@ ASTNode *parse_primary(Parser *parser){
                 return NULL;
             }
             if(!match(parser, TOKEN_RPAREN)){
-                printf("Error: Expected ')' after expression\n");
-                free_AST(expr);
+                spade_printf("Error: Expected ')' after expression\n");
                 return NULL;
             }
             return expr;
         }
 
         default: {
-            printf("Error: Unexpeted token '%s'\n", current_token(parser).value);
+            spade_printf("Error: Unexpeted token '%.*s'\n", current_token(parser).length, current_token(parser).start);
             return NULL;
         }
     }
@@ -839,12 +846,12 @@ ASTNode *parse_variable_declaration(Parser *parser){
     
     // check if token starts with a data type
     if(!is_data_type_token(token.type)){
-        printf("Error: Expected data type token, got %s\n", token.value);
+        spade_printf("Error: Expected data type token, got %.*s\n", token.length, token.start);
         return NULL;
     }
 
     // create variable declaration node
-    ASTNode *node = malloc(sizeof(ASTNode));
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
     node->type = AST_VARIABLE_DECLARATION; // set the type of the node
     node->data.var_declaration.var_type = token.type; // set the data type of variable in node
     advance(parser); // advance to the next token
@@ -853,12 +860,11 @@ ASTNode *parse_variable_declaration(Parser *parser){
     // check if the next token is an identifier
     token = current_token(parser);
     if(token.type != TOKEN_IDENTIFIER){
-        printf("Error: Expected identifier, got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected identifier, got %.*s\n", token.length, token.start);
         return NULL;
     }
 
-    node->data.var_declaration.name = strdup(token.value); // set the name of the variable
+    node->data.var_declaration.name = copy_token_string(parser, token); // set the name of the variable
     advance(parser); // advance to the next token
 
     // check if its declaration or initialization
@@ -868,8 +874,7 @@ ASTNode *parse_variable_declaration(Parser *parser){
         advance(parser); // advance to the next token
         node->data.var_declaration.value = parse_expression(parser); // parse the expression
         if(!node->data.var_declaration.value) {
-            printf("Expected expression after '=' \n");
-            free_AST(node);
+            spade_printf("Expected expression after '=' \n");
             return NULL;
         }
     }else{
@@ -878,8 +883,7 @@ ASTNode *parse_variable_declaration(Parser *parser){
     }
 
     if(!match(parser, TOKEN_SEMICOLON)){
-        printf("Expected ';' after variable declaration\n");
-        free_AST(node);
+        spade_printf("Expected ';' after variable declaration\n");
         return NULL;
     }
 
@@ -898,32 +902,31 @@ ASTNode *parse_variable_declaration(Parser *parser){
  */
 ASTNode *parse_parameter_list(Parser *parser){
     Token token = current_token(parser);
-    Token next = parser->tokens[parser->current + 1];
+    Token next = peek_token(parser);
 
     if(token.type == TOKEN_LPAREN && next.type == TOKEN_RPAREN){
         // Handle empty parameter list
         advance(parser); // skip LPAREN
         advance(parser); // skip RPAREN
-        ASTNode *node = malloc(sizeof(ASTNode));
+        ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
         node->type = AST_PARAMETER_LIST;
         node->data.parameter_list.capacity = 10;
         node->data.parameter_list.parameter_count = 0;
-        node->data.parameter_list.parameters = malloc(sizeof(ASTNode *) * node->data.parameter_list.capacity);
+        node->data.parameter_list.parameters = arena_alloc(&parser->arena, sizeof(ASTNode *) * node->data.parameter_list.capacity);
         return node;
     }
 
     advance(parser); // advance to the next token
-    ASTNode *node = malloc(sizeof(ASTNode));
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
     node->type = AST_PARAMETER_LIST; // set the type of the node
     node->data.parameter_list.capacity = 10;
     node->data.parameter_list.parameter_count = 0;
-    node->data.parameter_list.parameters = malloc(sizeof(ASTNode *) * node->data.parameter_list.capacity);
+    node->data.parameter_list.parameters = arena_alloc(&parser->arena, sizeof(ASTNode *) * node->data.parameter_list.capacity);
     token = current_token(parser);
 
     // check if token starts with a data type
     if(!is_data_type_token(token.type)){
-        printf("Error: Expected data type token, got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected data type token, got %.*s\n", token.length, token.start);
         return NULL;
     }
     // TODO: handle parameters that are expressions
@@ -939,19 +942,23 @@ ASTNode *parse_parameter_list(Parser *parser){
 
         if(is_data_type_token(token.type)){
             // create parameter node
-            ASTNode *parameter = malloc(sizeof(ASTNode));
+            ASTNode *parameter = arena_alloc(&parser->arena, sizeof(ASTNode));
             parameter->type = AST_PARAMETER; // set the type of the node
             parameter->data.parameter.type = token.type; // set the data type of variable in node
             advance(parser); // advance to the next token
             token = current_token(parser);
             if(token.type != TOKEN_IDENTIFIER){
-                printf("Error: Expected identifier, got %s\n", token.value);
-                free_AST(parameter);
-                free_AST(node);
+                spade_printf("Error: Expected identifier, got %.*s\n", token.length, token.start);
                 return NULL;
             }
 
-            parameter->data.parameter.name = strdup(token.value); // set the name of the variable
+            parameter->data.parameter.name = copy_token_string(parser, token); // set the name of the variable
+            if(node->data.parameter_list.parameter_count >= node->data.parameter_list.capacity){
+                node->data.parameter_list.parameters = arena_grow(&parser->arena, node->data.parameter_list.parameters,
+                    sizeof(ASTNode *) * node->data.parameter_list.capacity,
+                    sizeof(ASTNode *) * node->data.parameter_list.capacity * 2);
+                node->data.parameter_list.capacity *= 2;
+            }
             node->data.parameter_list.parameters[node->data.parameter_list.parameter_count++] = parameter; // add parameter to the list
             advance(parser); // advance to the next token
             token = current_token(parser);
@@ -981,12 +988,12 @@ ASTNode *parse_function_declaration(Parser *parser){
 
     // check if token starts with a data type
     if(!is_data_type_token(token.type)){
-        printf("Error: Expected data type token, got %s\n", token.value);
+        spade_printf("Error: Expected data type token, got %.*s\n", token.length, token.start);
         return NULL;
     }
 
     // create function declaration node
-    ASTNode *node = malloc(sizeof(ASTNode));
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
     node->type = AST_FUNCTION_DECLARATION; // set the type of the node
     node->data.function_declaration.return_type = token.type; // set the data type of variable in node
     advance(parser); // advance to the next token
@@ -996,8 +1003,7 @@ ASTNode *parse_function_declaration(Parser *parser){
 
     // check if the next token is indeed a task token
     if(token.type != TOKEN_TASK){
-        printf("Error: Expected task token, got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected task token, got %.*s\n", token.length, token.start);
         return NULL;
     }
     advance(parser);
@@ -1005,47 +1011,41 @@ ASTNode *parse_function_declaration(Parser *parser){
     // check if the next token is an identifier
     token = current_token(parser);
     if(token.type != TOKEN_IDENTIFIER){
-        printf("Error: Expected identifier, got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected identifier, got %.*s\n", token.length, token.start);
         return NULL;
     }
 
     // set the name of the function
-    node->data.function_declaration.name = strdup(token.value);
+    node->data.function_declaration.name = copy_token_string(parser, token);
     advance(parser); // advance to the next token
 
     // check if the next token is a left parenthesis
     token = current_token(parser);
     if(token.type != TOKEN_LPAREN){
-        printf("Error: Expected '(', got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected '(', got %.*s\n", token.length, token.start);
         return NULL;
     }
 
     node->data.function_declaration.parameters = parse_parameter_list(parser); // parse the parameter list
     if(!node->data.function_declaration.parameters){
-        printf("Error: Expected parameter list, got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected parameter list, got %.*s\n", token.length, token.start);
         return NULL;
     }
 
     token = current_token(parser);
 
     if(!match(parser, TOKEN_LBRACE)){
-        printf("Error: Expected '{', got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected '{', got %.*s\n", token.length, token.start);
         return NULL;
     }
 
     if(!match(parser, TOKEN_RBRACE)){
-        printf("Error: Expected '}', got %s. No support for function body\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected '}', got %.*s. No support for function body\n", token.length, token.start);
         return NULL;
     }
 
     if(!match(parser, TOKEN_SEMICOLON)){
-        printf("Error: Expected ';', got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected ';', got %.*s\n", token.length, token.start);
         return NULL;
     }
 
@@ -1055,24 +1055,52 @@ ASTNode *parse_function_declaration(Parser *parser){
 }
 
 
+/**
+ * Parses an assignment statement (`name = expression;`).
+ *
+ * @param parser The parser instance
+ * @return An AST_ASSIGNMENT node, or NULL on error
+ */
 ASTNode *parse_assignment(Parser *parser){
+    ASTNode *node = parse_assignment_clause(parser);
+    if(!node){
+        return NULL;
+    }
+
+    Token token = current_token(parser);
+    if(!match(parser, TOKEN_SEMICOLON)){
+        spade_printf("Error: Expected semicolon, got %.*s\n", token.length, token.start);
+        return NULL;
+    }
+
+    return node;
+}
+
+/**
+ * Parses an assignment without its terminating semicolon (`name = expression`).
+ *
+ * Used on its own for the update clause of a for loop, which ends at ')'.
+ *
+ * @param parser The parser instance
+ * @return An AST_ASSIGNMENT node, or NULL on error
+ */
+ASTNode *parse_assignment_clause(Parser *parser){
     Token token = current_token(parser);
 
     if(token.type != TOKEN_IDENTIFIER){
-        printf("Error: Expected identifier, got %s\n", token.value);
+        spade_printf("Error: Expected identifier, got %.*s\n", token.length, token.start);
         return NULL;
     }
     // create assignment node
-    ASTNode *node = malloc(sizeof(ASTNode));
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
     node->type = AST_ASSIGNMENT;
-    node->data.variable_assignment.name = strdup(token.value);
+    node->data.variable_assignment.name = copy_token_string(parser, token);
 
     advance(parser); // advance to next token which should be assignment token
     token = current_token(parser);
 
     if(!match(parser, TOKEN_ASSIGN)){
-        printf("Error: Expected assignment token, got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected assignment token, got %.*s\n", token.length, token.start);
         return NULL;
     }
 
@@ -1080,17 +1108,242 @@ ASTNode *parse_assignment(Parser *parser){
     node->data.variable_assignment.value = parse_expression(parser);
 
     if(!node->data.variable_assignment.value){
-        printf("Error: Unknown expression %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Unknown expression %.*s\n", token.length, token.start);
+        return NULL;
+    }
+
+    return node;
+}
+
+/**
+ * Parses a block of statements enclosed in braces.
+ *
+ * @param parser The parser instance
+ * @return An AST_BLOCK node, or NULL on error
+ */
+ASTNode *parse_block(Parser *parser){
+    Token token = current_token(parser);
+    if(!match(parser, TOKEN_LBRACE)){
+        spade_printf("Error: Expected '{', got %.*s\n", token.length, token.start);
+        return NULL;
+    }
+
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
+    node->type = AST_BLOCK;
+    node->data.block.capacity = 4;
+    node->data.block.statement_count = 0;
+    node->data.block.statements = arena_alloc(&parser->arena, sizeof(ASTNode *) * node->data.block.capacity);
+
+    while(current_token(parser).type != TOKEN_RBRACE){
+        if(current_token(parser).type == TOKEN_EOF){
+            spade_printf("Error: Expected '}' before end of file\n");
+            return NULL;
+        }
+
+        ASTNode *stmt = parse_statement(parser);
+        if(!stmt){
+            return NULL;
+        }
+
+        // Resize array if needed
+        if(node->data.block.statement_count >= node->data.block.capacity){
+            node->data.block.statements = arena_grow(&parser->arena, node->data.block.statements,
+                sizeof(ASTNode *) * node->data.block.capacity,
+                sizeof(ASTNode *) * node->data.block.capacity * 2);
+            node->data.block.capacity *= 2;
+        }
+
+        node->data.block.statements[node->data.block.statement_count++] = stmt;
+    }
+    advance(parser); // skip RBRACE
+
+    return node;
+}
+
+/**
+ * Parses a parenthesized condition, as used by if and while.
+ *
+ * @param parser The parser instance
+ * @param keyword The statement's keyword, for error messages
+ * @return The condition expression, or NULL on error
+ */
+ASTNode *parse_condition(Parser *parser, const char *keyword){
+    Token token = current_token(parser);
+    if(!match(parser, TOKEN_LPAREN)){
+        spade_printf("Error: Expected '(' after %s, got %.*s\n", keyword, token.length, token.start);
+        return NULL;
+    }
+
+    token = current_token(parser);
+    ASTNode *condition = parse_expression(parser);
+    if(!condition){
+        spade_printf("Error: Expected condition after '%s (', got %.*s\n", keyword, token.length, token.start);
+        return NULL;
+    }
+
+    token = current_token(parser);
+    if(!match(parser, TOKEN_RPAREN)){
+        spade_printf("Error: Expected ')' after %s condition, got %.*s\n", keyword, token.length, token.start);
+        return NULL;
+    }
+
+    return condition;
+}
+
+/**
+ * Parses an if statement with an optional else branch.
+ *
+ * Both branches are single statements; a block counts as one, and
+ * `else if` is an else branch holding another if statement.
+ *
+ * @param parser The parser instance
+ * @return An AST_IF node, or NULL on error
+ */
+ASTNode *parse_if_statement(Parser *parser){
+    advance(parser); // skip IF
+
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
+    node->type = AST_IF;
+    node->data.if_statement.condition = parse_condition(parser, "if");
+    if(!node->data.if_statement.condition){
+        return NULL;
+    }
+
+    node->data.if_statement.then_branch = parse_statement(parser);
+    if(!node->data.if_statement.then_branch){
         return NULL;
     }
 
+    node->data.if_statement.else_branch = NULL;
+    if(match(parser, TOKEN_ELSE)){
+        node->data.if_statement.else_branch = parse_statement(parser);
+        if(!node->data.if_statement.else_branch){
+            return NULL;
+        }
+    }
+
+    return node;
+}
+
+/**
+ * Parses a while loop.
+ *
+ * @param parser The parser instance
+ * @return An AST_WHILE node, or NULL on error
+ */
+ASTNode *parse_while_statement(Parser *parser){
+    advance(parser); // skip WHILE
+
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
+    node->type = AST_WHILE;
+    node->data.while_loop.condition = parse_condition(parser, "while");
+    if(!node->data.while_loop.condition){
+        return NULL;
+    }
+
+    node->data.while_loop.body = parse_statement(parser);
+    if(!node->data.while_loop.body){
+        return NULL;
+    }
+
+    return node;
+}
+
+/**
+ * Parses a for loop: `for (initializer; condition; update) body`.
+ *
+ * The initializer is a variable declaration or an assignment, the update an
+ * assignment; any of the three clauses may be left empty.
+ *
+ * @param parser The parser instance
+ * @return An AST_FOR node, or NULL on error
+ */
+ASTNode *parse_for_statement(Parser *parser){
+    advance(parser); // skip FOR
+
+    Token token = current_token(parser);
+    if(!match(parser, TOKEN_LPAREN)){
+        spade_printf("Error: Expected '(' after for, got %.*s\n", token.length, token.start);
+        return NULL;
+    }
+
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
+    node->type = AST_FOR;
+    node->data.for_loop.initializer = NULL;
+    node->data.for_loop.condition = NULL;
+    node->data.for_loop.update = NULL;
+
+    // Both initializer forms consume the ';' that ends the clause
+    token = current_token(parser);
+    if(is_data_type_token(token.type) && peek_token(parser).type == TOKEN_IDENTIFIER){
+        node->data.for_loop.initializer = parse_variable_declaration(parser);
+        if(!node->data.for_loop.initializer){
+            return NULL;
+        }
+    }else if(token.type == TOKEN_IDENTIFIER){
+        node->data.for_loop.initializer = parse_assignment(parser);
+        if(!node->data.for_loop.initializer){
+            return NULL;
+        }
+    }else if(!match(parser, TOKEN_SEMICOLON)){
+        spade_printf("Error: Expected declaration, assignment or ';' in for, got %.*s\n", token.length, token.start);
+        return NULL;
+    }
+
+    if(current_token(parser).type != TOKEN_SEMICOLON){
+        token = current_token(parser);
+        node->data.for_loop.condition = parse_expression(parser);
+        if(!node->data.for_loop.condition){
+            spade_printf("Error: Expected condition in for, got %.*s\n", token.length, token.start);
+            return NULL;
+        }
+    }
+    token = current_token(parser);
     if(!match(parser, TOKEN_SEMICOLON)){
-        printf("Error: Expected semicolon, got %s\n", token.value);
-        free_AST(node);
+        spade_printf("Error: Expected ';' after for condition, got %.*s\n", token.length, token.start);
+        return NULL;
+    }
+
+    if(current_token(parser).type != TOKEN_RPAREN){
+        node->data.for_loop.update = parse_assignment_clause(parser);
+        if(!node->data.for_loop.update){
+            return NULL;
+        }
+    }
+    token = current_token(parser);
+    if(!match(parser, TOKEN_RPAREN)){
+        spade_printf("Error: Expected ')' after for clauses, got %.*s\n", token.length, token.start);
+        return NULL;
+    }
+
+    node->data.for_loop.body = parse_statement(parser);
+    if(!node->data.for_loop.body){
         return NULL;
     }
 
     return node;
+}
 
-}
\ No newline at end of file
+/**
+ * Parses a break or continue statement.
+ *
+ * Whether it is inside a loop is checked by semantic analysis.
+ *
+ * @param parser The parser instance
+ * @return An AST_BREAK or AST_CONTINUE node, or NULL on error
+ */
+ASTNode *parse_loop_control(Parser *parser){
+    Token token = current_token(parser);
+    ASTNode *node = arena_alloc(&parser->arena, sizeof(ASTNode));
+    node->type = token.type == TOKEN_BREAK ? AST_BREAK : AST_CONTINUE;
+    advance(parser); // skip BREAK or CONTINUE
+
+    if(!match(parser, TOKEN_SEMICOLON)){
+        token = current_token(parser);
+        spade_printf("Error: Expected ';' after %s, got %.*s\n",
+               node->type == AST_BREAK ? "break" : "continue", token.length, token.start);
+        return NULL;
+    }
+
+    return node;
+}
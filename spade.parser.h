@@ -2,6 +2,7 @@
 #define SPADE_PARSER_H
 
 #include "spade.lexer.h"
+#include "spade.arena.h"
 
 typedef enum {
     AST_PROGRAM,              // Container for multiple statements
@@ -19,6 +20,12 @@ typedef enum {
     AST_STRING_LITERAL,
     AST_BINARY_OPERATION,
     AST_UNARY_OPERATION,
+    AST_BLOCK,                // { statements }
+    AST_IF,
+    AST_WHILE,
+    AST_FOR,
+    AST_BREAK,
+    AST_CONTINUE,
     AST_NULL
 } ASTNodeType;
 
@@ -93,6 +100,7 @@ typedef struct ASTNode {
 
         struct {
             char *value;
+            int length;                       // Length in bytes (the value may contain NUL bytes)
         } string_lit;
 
         struct {
@@ -105,19 +113,63 @@ typedef struct ASTNode {
             enum TokenType op;
             struct ASTNode *operand;
         } unary_op;
+
+        struct {
+            struct ASTNode **statements;      // Array of statement pointers
+            int statement_count;              // Number of statements
+            int capacity;                     // Allocated capacity
+        } block;
+
+        struct {
+            struct ASTNode *condition;
+            struct ASTNode *then_branch;      // Statement or block run when the condition holds
+            struct ASTNode *else_branch;      // NULL if there is no else
+        } if_statement;
+
+        struct {
+            struct ASTNode *condition;
+            struct ASTNode *body;
+        } while_loop;
+
+        struct {
+            struct ASTNode *initializer;      // Declaration or assignment, NULL if omitted
+            struct ASTNode *condition;        // NULL if omitted (loops until break)
+            struct ASTNode *update;           // Assignment run after each iteration, NULL if omitted
+            struct ASTNode *body;
+        } for_loop;
         
-        // null doesn't need data
+        // break, continue and null don't need data
     } data;
 } ASTNode;
 
+#define PARSER_WINDOW 4  // Tokens kept in memory: previous, current and one of lookahead (power of two)
+
+/**
+ * Parser state.
+ *
+ * Tokens are pulled from the lexer on demand into a small ring buffer, so the
+ * parser never holds more than PARSER_WINDOW tokens regardless of file size.
+ * Every AST node, child array and name is bump-allocated from the parser's
+ * arena, and free_parser releases all of it at once.
+ *
+ * @param lexer The token stream being parsed
+ * @param window Ring buffer of recently lexed tokens, indexed by stream position
+ * @param current Stream position of the current token
+ * @param lexed Number of tokens pulled from the lexer so far
+ * @param arena Owns the memory of every AST the parser builds
+ */
 typedef struct {
-    Token *tokens;
+    Lexer *lexer;
+    Token window[PARSER_WINDOW];
     int current;
-    int token_count;
+    int lexed;
+    Arena arena;
 } Parser;
 
+void init_parser(Parser *parser, Lexer *lexer);
+void free_parser(Parser *parser);
+
 void print_AST(ASTNode *node, int indent);
-void free_AST(ASTNode *node);
 ASTNode *parse_program(Parser *parser);
 ASTNode *parse_statement(Parser *parser);
 ASTNode *parse_expression(Parser *parser);
@@ -134,5 +186,12 @@ ASTNode *parse_variable_declaration(Parser *parser);
 ASTNode *parse_function_declaration(Parser *parser);
 ASTNode *parse_parameter_list(Parser *parser);
 ASTNode *parse_assignment(Parser *parser);
+ASTNode *parse_assignment_clause(Parser *parser);
+ASTNode *parse_block(Parser *parser);
+ASTNode *parse_condition(Parser *parser, const char *keyword);
+ASTNode *parse_if_statement(Parser *parser);
+ASTNode *parse_while_statement(Parser *parser);
+ASTNode *parse_for_statement(Parser *parser);
+ASTNode *parse_loop_control(Parser *parser);
 
 #endif
\ No newline at end of file
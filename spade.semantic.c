@@ -1,325 +1,397 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "spade.parser.h"
+#include "spade.flat.h"
 #include "spade.symbol.h"
+#include "spade.semantic.h"
+#include "spade.output.h"
 
 /**
- * Recursively determines the type of an expression by analyzing its AST structure.
- * 
- * @param expr The expression AST node to analyze
- * @param symbol_table The symbol table for variable lookups
+ * Determines the type of an expression stored in a flat AST.
+ *
+ * The expression's nodes are scanned front to back; since operands always
+ * precede their operator, each node is typed exactly once from the already
+ * computed types of its operands. A call's arguments are typed through the
+ * args table and the scan then jumps past them.
+ *
+ * Every node's type is recorded in ast->types, and identifiers and calls
+ * record the symbol they resolved to in ast->symbols, for IR generation.
+ *
+ * @param ast The flat AST holding the expression
+ * @param range The expression's node range (root is -1 for a missing expression)
+ * @param symbol_table The symbol table for variable and function lookups
  * @return The TokenType representing the expression's type, or -1 for type errors
  */
-enum TokenType get_expression_type(ASTNode *expr, SymbolTable *symbol_table) {
-    if (!expr) return -1;
-
-    switch (expr->type) {
-        case AST_NUMBER:
-            return TOKEN_INT;
-            
-        case AST_BOOLEAN:
-            return TOKEN_BOOL;
-            
-        case AST_STRING_LITERAL:
-            return TOKEN_STRING;
-            
-        case AST_NULL:
-            return TOKEN_NULL;
-            
-        case AST_IDENTIFIER: {
-            Symbol *sym = lookup_symbol_table(symbol_table, expr->data.identifier.name);
-            if (sym) return sym->type;
-            printf("Error: Undeclared variable '%s'\n", expr->data.identifier.name);
-            return -1;
-        }
-        
-        case AST_BINARY_OPERATION: {
-            enum TokenType left_type = get_expression_type(expr->data.bin_op.left, symbol_table);
-            enum TokenType right_type = get_expression_type(expr->data.bin_op.right, symbol_table);
-            
-            if (left_type == -1 || right_type == -1) return -1;
-
-            // TESTING STRING CONCATENATION IMPLEMENTATION
-            if(expr->data.bin_op.op == TOKEN_PLUS && left_type == TOKEN_STRING && right_type == TOKEN_STRING){
-                // should return a proper token indicating string concatenation
-                return TOKEN_STRING;
-            }
-            
-            // Arithmetic operators: +, -, *, /, %
-            if (expr->data.bin_op.op == TOKEN_PLUS || expr->data.bin_op.op == TOKEN_MINUS ||
-                expr->data.bin_op.op == TOKEN_MULTIPLY || expr->data.bin_op.op == TOKEN_DIVIDE ||
-                expr->data.bin_op.op == TOKEN_MODULO || expr->data.bin_op.op == TOKEN_POWER) {
-                if (left_type == TOKEN_INT && right_type == TOKEN_INT) {
-                    return TOKEN_INT;
+enum TokenType get_expression_type(FlatAST *ast, FlatRange range, SymbolTable *symbol_table) {
+    if (range.root < 0) return -1;
+
+    enum TokenType *types = ast->types;
+
+    for (int i = range.start; i <= range.root; i++) {
+        switch (ast->kinds[i]) {
+            case AST_NUMBER:
+                types[i] = TOKEN_INT;
+                break;
+
+            case AST_BOOLEAN:
+                types[i] = TOKEN_BOOL;
+                break;
+
+            case AST_STRING_LITERAL:
+                types[i] = TOKEN_STRING;
+                break;
+
+            case AST_NULL:
+                types[i] = TOKEN_NULL;
+                break;
+
+            case AST_IDENTIFIER: {
+                const char *name = ast->names[ast->values[i]];
+                Symbol *sym = lookup_symbol_table(symbol_table, name);
+                ast->symbols[i] = sym;
+                if (sym) {
+                    types[i] = sym->type;
+                } else {
+                    spade_printf("Error: Undeclared variable '%s'\n", name);
+                    types[i] = -1;
                 }
-                printf("Error: Arithmetic operations require int operands\n");
-                return -1;
+                break;
             }
-            
-            // Comparison operators: <, >, <=, >=, ==, !=
-            if (expr->data.bin_op.op == TOKEN_LESS_THAN || expr->data.bin_op.op == TOKEN_GREATER_THAN ||
-                expr->data.bin_op.op == TOKEN_LESS_THAN_EQUALS || expr->data.bin_op.op == TOKEN_GREATER_THAN_EQUALS ||
-                expr->data.bin_op.op == TOKEN_EQUALS || expr->data.bin_op.op == TOKEN_NOT_EQUALS) {
-                if (left_type == right_type) {
-                    return TOKEN_BOOL;
+
+            case AST_BINARY_OPERATION: {
+                enum TokenType op = ast->values[i];
+                enum TokenType left_type = ast->lefts[i] < 0 ? -1 : types[ast->lefts[i]];
+                enum TokenType right_type = ast->rights[i] < 0 ? -1 : types[ast->rights[i]];
+                types[i] = -1;
+
+                if (left_type == -1 || right_type == -1) break;
+
+                // TESTING STRING CONCATENATION IMPLEMENTATION
+                if (op == TOKEN_PLUS && left_type == TOKEN_STRING && right_type == TOKEN_STRING) {
+                    // should return a proper token indicating string concatenation
+                    types[i] = TOKEN_STRING;
+                    break;
                 }
-                printf("Error: Comparison requires operands of same type\n");
-                return -1;
-            }
-            
-            // Logical operators: &&, ||
-            if (expr->data.bin_op.op == TOKEN_AND || expr->data.bin_op.op == TOKEN_OR) {
-                if (left_type == TOKEN_BOOL && right_type == TOKEN_BOOL) {
-                    return TOKEN_BOOL;
+
+                // Arithmetic operators: +, -, *, /, %
+                if (op == TOKEN_PLUS || op == TOKEN_MINUS || op == TOKEN_MULTIPLY ||
+                    op == TOKEN_DIVIDE || op == TOKEN_MODULO || op == TOKEN_POWER) {
+                    if (left_type == TOKEN_INT && right_type == TOKEN_INT) {
+                        types[i] = TOKEN_INT;
+                        break;
+                    }
+                    spade_printf("Error: Arithmetic operations require int operands\n");
+                    break;
                 }
-                printf("Error: Logical operations require boolean operands\n");
-                return -1;
-            }
-            
-            printf("Error: Unknown binary operator\n");
-            return -1;
-        }
 
-        case AST_FUNCTION_CALL: {
-            char *func_name = expr->data.function_call.name;
-            ASTNode *arg_list = expr->data.function_call.arguments;
-            int arg_count = arg_list->data.argument_list.argument_count;
-            
-            // Create Param array (not AST nodes)
-            Param *params = malloc(sizeof(Param) * arg_count);
-            for(int i = 0; i < arg_count; i++) {
-                ASTNode *arg_expr = arg_list->data.argument_list.arguments[i]->data.argument.value;
-                params[i].type = get_expression_type(arg_expr, symbol_table);
-                params[i].name = NULL;
-                
-                if(params[i].type == -1) {
-                    free(params);
-                    return -1;
+                // Comparison operators: <, >, <=, >=, ==, !=
+                if (op == TOKEN_LESS_THAN || op == TOKEN_GREATER_THAN ||
+                    op == TOKEN_LESS_THAN_EQUALS || op == TOKEN_GREATER_THAN_EQUALS ||
+                    op == TOKEN_EQUALS || op == TOKEN_NOT_EQUALS) {
+                    if (left_type == right_type) {
+                        types[i] = TOKEN_BOOL;
+                        break;
+                    }
+                    spade_printf("Error: Comparison requires operands of same type\n");
+                    break;
                 }
+
+                // Logical operators: &&, ||
+                if (op == TOKEN_AND || op == TOKEN_OR) {
+                    if (left_type == TOKEN_BOOL && right_type == TOKEN_BOOL) {
+                        types[i] = TOKEN_BOOL;
+                        break;
+                    }
+                    spade_printf("Error: Logical operations require boolean operands\n");
+                    break;
+                }
+
+                spade_printf("Error: Unknown binary operator\n");
+                break;
             }
-            
-            Symbol *function = lookup_symbol_table_function(symbol_table, func_name, params, arg_count);
-            free(params);
-            
-            if(function != NULL) {
-                return function->type;
-            }
-            
-            printf("Error: Function '%s' not found\n", func_name);
-            return -1;
-        }
-        
-        default:
-            printf("Error: Unknown expression type\n");
-            return -1;
-    }
-}
 
+            case AST_UNARY_OPERATION: {
+                enum TokenType operand_type = ast->lefts[i] < 0 ? -1 : types[ast->lefts[i]];
+                types[i] = -1;
 
-/**
- * Recursively analyzes an Abstract Syntax Tree (AST) for semantic correctness.
- * 
- * This function performs semantic analysis on different types of AST nodes, including:
- * - Variable declarations (adding symbols to the symbol table)
- * - Identifier resolution and validation
- * - Binary operation traversal
- * 
- * @param tree The root or current node of the Abstract Syntax Tree to analyze
- * @param symbol_table The symbol table used for tracking declared variables and their types
- */
-void analyze_AST(ASTNode *tree, SymbolTable *symbol_table){
-    if(tree == NULL){
-        return;
-    }
+                if (operand_type == -1) break;
 
-    switch(tree->type){
-        case AST_PROGRAM: {
-            // Analyze all statements in the program
-            for(int i = 0; i < tree->data.program.statement_count; i++){
-                analyze_AST(tree->data.program.statements[i], symbol_table);
-            }
-            break;
-        }
-        
-        case AST_VARIABLE_DECLARATION:{
-            // Check for redeclaration
-            if(!add_symbol(symbol_table, tree->data.var_declaration.name , tree->data.var_declaration.var_type)){
-                if(symbol_table->count >= MAX_SYMBOLS){
-                    printf("Error: Symbol table is full\n");
-                    return;
+                if (ast->values[i] == TOKEN_MINUS) {
+                    if (operand_type == TOKEN_INT) {
+                        types[i] = TOKEN_INT;
+                        break;
+                    }
+                    spade_printf("Error: Negation requires an int operand\n");
+                    break;
+                }
+
+                if (ast->values[i] == TOKEN_NOT) {
+                    if (operand_type == TOKEN_BOOL) {
+                        types[i] = TOKEN_BOOL;
+                        break;
+                    }
+                    spade_printf("Error: Logical not requires a boolean operand\n");
+                    break;
                 }
-                printf("Error: Variable '%s' already declared\n", tree->data.var_declaration.name);
-                return;
+
+                spade_printf("Error: Unknown unary operator\n");
+                break;
             }
 
-            // Type check the initializer if present
-            if(tree->data.var_declaration.value != NULL){
-                enum TokenType expr_type = get_expression_type(tree->data.var_declaration.value, symbol_table);
-                if(expr_type == -1){
-                    printf("Error: Invalid expression in variable declaration\n");
-                    return;
+            case AST_FUNCTION_CALL: {
+                FlatCall *call = &ast->calls[ast->values[i]];
+                types[i] = -1;
+
+                // Create Param array (not AST nodes)
+                Param *params = malloc(sizeof(Param) * (call->arg_count ? call->arg_count : 1));
+                int typed = 1;
+                for (int a = 0; a < call->arg_count; a++) {
+                    params[a].type = get_expression_type(ast, ast->args[call->arg_first + a], symbol_table);
+                    params[a].name = NULL;
+
+                    if (params[a].type == -1) {
+                        typed = 0;
+                        break;
+                    }
                 }
-                if(expr_type != tree->data.var_declaration.var_type && (expr_type != TOKEN_STRING_LITERAL && tree->data.var_declaration.var_type == TOKEN_STRING)){
-                    printf("Error: Type mismatch in declaration of '%s'. Cannot assign %s to %s\n",
-                           tree->data.var_declaration.name,
-                           get_token_name(expr_type),
-                           get_token_name(tree->data.var_declaration.var_type));
-                    return;
+
+                if (typed) {
+                    Symbol *function = lookup_symbol_table_function(symbol_table, call->name, params, call->arg_count);
+                    ast->symbols[i] = function;
+                    if (function != NULL) {
+                        types[i] = function->type;
+                    } else {
+                        spade_printf("Error: Function '%s' not found\n", call->name);
+                    }
                 }
-                analyze_AST(tree->data.var_declaration.value, symbol_table);
+                free(params);
+
+                // The arguments have been typed (or skipped); continue after them
+                i = call->end - 1;
+                break;
             }
-            break;
+
+            default:
+                spade_printf("Error: Unknown expression type\n");
+                types[i] = -1;
+                break;
         }
+    }
 
-        case AST_IDENTIFIER: {
-            if(tree->data.identifier.name == NULL){
-                printf("Error: Identifier is NULL\n");
-                return;
-            }
+    return types[range.root];
+}
 
-            if(lookup_symbol_table(symbol_table, tree->data.identifier.name) == NULL){
-                printf("Error: Identifier does not exists\n");
-                return;
-            }
-            break;
+
+/**
+ * Type checks the condition of an if statement or loop.
+ *
+ * @param ast The flat AST holding the condition
+ * @param statement The statement the condition belongs to
+ * @param symbol_table The scope the condition is evaluated in
+ * @param keyword The statement's keyword, for error messages
+ * @return 1 if the condition is a valid bool expression, 0 after reporting an error
+ */
+int check_condition(FlatAST *ast, FlatStatement *statement, SymbolTable *symbol_table, const char *keyword){
+    enum TokenType condition_type = get_expression_type(ast, statement->expression, symbol_table);
+    if(condition_type == -1){
+        spade_printf("Error: Invalid expression in %s condition\n", keyword);
+        return 0;
+    }
+    if(condition_type != TOKEN_BOOL){
+        spade_printf("Error: %s condition must be bool, got %s\n", keyword, get_token_name(condition_type));
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Analyzes the body of an if branch or a loop.
+ *
+ * A body written without braces is a single statement. If it is a
+ * declaration it gets a scope of its own, as a block would, so the name
+ * cannot be used after the statement, where the declaration may never have
+ * run. The scope is stored in the declaration for IR generation.
+ *
+ * @param ast The flat AST of the program
+ * @param first Index of the body's first statement
+ * @param end Index just past the body
+ * @param symbol_table The scope of the if or loop statement
+ * @param loop_depth Number of loops enclosing the body
+ * @return The number of errors reported
+ */
+int analyze_body(FlatAST *ast, int first, int end, SymbolTable *symbol_table, int loop_depth){
+    if(first < end && (ast->statements[first].kind == AST_VARIABLE_DECLARATION ||
+                       ast->statements[first].kind == AST_FUNCTION_DECLARATION)){
+        SymbolTable *scope = open_scope(symbol_table);
+        if(!scope){
+            spade_printf("Error: Out of memory opening a block scope\n");
+            return 1;
         }
+        ast->statements[first].scope = scope;
+        symbol_table = scope;
+    }
+    return analyze_statements(ast, first, end, symbol_table, loop_depth);
+}
 
-        case AST_ASSIGNMENT: {
-            // check if the variable exists
+/**
+ * Analyzes a range of statements that share a scope.
+ *
+ * The statements are checked in program order. Statements nested in a
+ * block, if or loop follow it in the table, so the range is scanned front to
+ * back and each of those hands its nested range to a recursive call before
+ * the scan skips past it:
+ * - Variable declarations add their symbol and type check the initializer
+ * - Assignments check that the variable exists and the value's type matches
+ * - Function declarations add the function and its signature
+ * - Blocks open a scope nested in the current one
+ * - if, while and for check that their condition is a bool, and analyze
+ *   their branches and bodies with analyze_body
+ * - break and continue must be inside a loop
+ *
+ * @param ast The flat AST of the program
+ * @param first Index of the first statement to analyze
+ * @param end Index just past the last statement to analyze
+ * @param symbol_table The scope the statements are declared in
+ * @param loop_depth Number of loops enclosing the statements
+ * @return The number of errors reported
+ */
+int analyze_statements(FlatAST *ast, int first, int end, SymbolTable *symbol_table, int loop_depth){
+    int error_count = 0;
 
-            Symbol *symbol = lookup_symbol_table(symbol_table, tree->data.variable_assignment.name);
+    for(int s = first; s < end; s = ast->statements[s].end){
+        FlatStatement *statement = &ast->statements[s];
 
-            if(!symbol){
-                printf("Error: Variable '%s' does not exist\n", tree->data.variable_assignment.name);
-                return;
-            }
+        switch(statement->kind){
+            case AST_VARIABLE_DECLARATION:{
+                // Check for redeclaration
+                if(!add_symbol(symbol_table, statement->name, statement->type)){
+                    spade_printf("Error: Variable '%s' already declared\n", statement->name);
+                    error_count++;
+                    break;
+                }
 
-            // check if right side is a valid expression and if it matches the type of the variable
-            enum TokenType expr_type = get_expression_type(tree->data.variable_assignment.value, symbol_table);
-            if(expr_type == -1){
-                printf("Error: Invalid expression in assignment\n");
-                return;
+                // Type check the initializer if present
+                if(statement->expression.start >= 0){
+                    enum TokenType expr_type = get_expression_type(ast, statement->expression, symbol_table);
+                    if(expr_type == -1){
+                        spade_printf("Error: Invalid expression in variable declaration\n");
+                        error_count++;
+                        break;
+                    }
+                    if(expr_type != statement->type && (expr_type != TOKEN_STRING_LITERAL && statement->type == TOKEN_STRING)){
+                        spade_printf("Error: Type mismatch in declaration of '%s'. Cannot assign %s to %s\n",
+                               statement->name,
+                               get_token_name(expr_type),
+                               get_token_name(statement->type));
+                        error_count++;
+                        break;
+                    }
+                }
+                break;
             }
 
-            if(symbol->type != expr_type){
-                printf("Error: Type mismatch in assignment of '%s'. Cannot assign %s to %s\n",
-                       tree->data.variable_assignment.name,
-                       get_token_name(expr_type),
-                       get_token_name(symbol->type));
-                return;
-            }
+            case AST_ASSIGNMENT: {
+                // check if the variable exists
+                Symbol *symbol = lookup_symbol_table(symbol_table, statement->name);
 
-            // Recursively analyze the right side of the assignment
-            analyze_AST(tree->data.variable_assignment.value, symbol_table);
-            break;
-        }
+                if(!symbol){
+                    spade_printf("Error: Variable '%s' does not exist\n", statement->name);
+                    error_count++;
+                    break;
+                }
 
-        case AST_BINARY_OPERATION: {
-            // Check type compatibility of binary operation
-            enum TokenType result_type = get_expression_type(tree, symbol_table);
-            if(result_type == -1){
-                printf("Error: Type mismatch in binary operation\n");
-                return;
-            }
-            
-            // Recursively analyze operands
-            analyze_AST(tree->data.bin_op.left, symbol_table);
-            analyze_AST(tree->data.bin_op.right, symbol_table);
-            break;
-        }
+                // check if right side is a valid expression and if it matches the type of the variable
+                enum TokenType expr_type = get_expression_type(ast, statement->expression, symbol_table);
+                if(expr_type == -1){
+                    spade_printf("Error: Invalid expression in assignment\n");
+                    error_count++;
+                    break;
+                }
 
-        case AST_FUNCTION_DECLARATION: {
-            // Convert AST parameter list to Param array
-            ASTNode *param_list_ast = tree->data.function_declaration.parameters;
-            int param_count = param_list_ast->data.parameter_list.parameter_count;
-            
-            Param *params = malloc(sizeof(Param) * param_count);
-            for(int i = 0; i < param_count; i++) {
-                ASTNode *param_ast = param_list_ast->data.parameter_list.parameters[i];
-                params[i].name = strdup(param_ast->data.parameter.name);
-                params[i].type = param_ast->data.parameter.type;
-            }
-            
-            if(!add_symbol_function(symbol_table, tree->data.function_declaration.name, 
-                                   tree->data.function_declaration.return_type, params, param_count)) {
-                printf("Error: Function '%s' already declared\n", tree->data.function_declaration.name);
-                // Free allocated memory
-                for(int i = 0; i < param_count; i++) {
-                    free(params[i].name);
+                if(symbol->type != expr_type){
+                    spade_printf("Error: Type mismatch in assignment of '%s'. Cannot assign %s to %s\n",
+                           statement->name,
+                           get_token_name(expr_type),
+                           get_token_name(symbol->type));
+                    error_count++;
+                    break;
                 }
-                free(params);
-                return;
+                break;
             }
-            
-            // Free allocated memory
-            for(int i = 0; i < param_count; i++) {
-                free(params[i].name);
-            }
-            free(params);
-            
-            // For now, just analyze the parameters
-            if(tree->data.function_declaration.parameters) {
-                analyze_AST(tree->data.function_declaration.parameters, symbol_table);
-            }
-            if(tree->data.function_declaration.body) {
-                analyze_AST(tree->data.function_declaration.body, symbol_table);
+
+            case AST_FUNCTION_DECLARATION: {
+                // add_symbol_function copies the parameters, so the flat AST's table can be passed directly
+                Param *params = statement->param_count ? ast->params + statement->param_first : NULL;
+                if(!add_symbol_function(symbol_table, statement->name, statement->type,
+                                       params, statement->param_count)) {
+                    spade_printf("Error: Function '%s' already declared\n", statement->name);
+                    error_count++;
+                }
+                break;
             }
-            break;
-        }
 
-        case AST_PARAMETER_LIST: {
-            // Analyze all parameters
-            for(int i = 0; i < tree->data.parameter_list.parameter_count; i++){
-                analyze_AST(tree->data.parameter_list.parameters[i], symbol_table);
+            case AST_BLOCK: {
+                SymbolTable *scope = open_scope(symbol_table);
+                if(!scope){
+                    spade_printf("Error: Out of memory opening a block scope\n");
+                    error_count++;
+                    break;
+                }
+                statement->scope = scope;
+                error_count += analyze_statements(ast, s + 1, statement->end, scope, loop_depth);
+                break;
             }
-            break;
-        }
 
-        case AST_PARAMETER: {
-            // TODO: expression type checking
-            // parameters are already checked during function declaration and added to local symbol table
-            break;
-        }
+            case AST_IF:
+                if(!check_condition(ast, statement, symbol_table, "if")){
+                    error_count++;
+                }
+                error_count += analyze_body(ast, s + 1, statement->alternative, symbol_table, loop_depth);
+                error_count += analyze_body(ast, statement->alternative, statement->end, symbol_table, loop_depth);
+                break;
 
+            case AST_WHILE:
+            case AST_FOR:
+                // A for loop without a condition runs until it breaks
+                if(statement->expression.start >= 0 &&
+                   !check_condition(ast, statement, symbol_table, statement->kind == AST_WHILE ? "while" : "for")){
+                    error_count++;
+                }
+                error_count += analyze_body(ast, s + 1, statement->alternative, symbol_table, loop_depth + 1);
+                error_count += analyze_statements(ast, statement->alternative, statement->end, symbol_table, loop_depth + 1);
+                break;
 
-        case AST_FUNCTION_CALL: {
-            char *function_name = tree->data.function_call.name;
-            ASTNode *arg_list = tree->data.function_call.arguments;
-            int arg_count = arg_list->data.argument_list.argument_count;
-            
-            Param *params = malloc(sizeof(Param) * arg_count);
-            for(int i = 0; i < arg_count; i++) {
-                ASTNode *arg_expr = arg_list->data.argument_list.arguments[i]->data.argument.value;
-                params[i].type = get_expression_type(arg_expr, symbol_table);
-                params[i].name = NULL;
-                
-                if(params[i].type == -1) {
-                    printf("Error: Invalid expression as argument in function call\n");
-                    free(params);
-                    return;
+            case AST_BREAK:
+            case AST_CONTINUE:
+                if(loop_depth == 0){
+                    spade_printf("Error: '%s' outside of a loop\n", statement->kind == AST_BREAK ? "break" : "continue");
+                    error_count++;
                 }
-            }
-            
-            if(lookup_symbol_table_function(symbol_table, function_name, params, arg_count) == NULL) {
-                printf("Error: Function '%s' not declared\n", function_name);
-                free(params);
-                return;
-            }
-            
-            free(params);
-            break;
-        }
+                break;
 
-        case AST_NUMBER:
-        case AST_BOOLEAN:
-        case AST_STRING_LITERAL:
-        case AST_NULL:
-            // These are leaf nodes, no need to analyze further
-            break;
+            default:
+                spade_printf("Warning: Unknown AST node type in semantic analysis: %d\n", statement->kind);
+                break;
+        }
+    }
+    return error_count;
+}
 
-        default:
-            printf("Warning: Unknown AST node type in semantic analysis: %d\n", tree->type);
-            break;
+/**
+ * Analyzes a flattened program for semantic correctness.
+ *
+ * The expressions that get type checked are left annotated with their node
+ * types and resolved symbols, and blocks with the scopes opened for them,
+ * for IR generation.
+ *
+ * @param ast The flat AST of the program to analyze
+ * @param symbol_table The symbol table used for tracking declared variables and their types
+ * @return The number of errors reported
+ */
+int analyze_AST(FlatAST *ast, SymbolTable *symbol_table){
+    if(ast == NULL){
+        return 0;
     }
-}
\ No newline at end of file
+
+    return analyze_statements(ast, 0, ast->statement_count, symbol_table, 0);
+}
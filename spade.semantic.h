@@ -1,9 +1,11 @@
 #ifndef SPADE_SEM_H
 #define SPADE_SEM_H
 
-#include "spade.parser.h"
+#include "spade.flat.h"
 #include "spade.symbol.h"
 
-void analyze_AST(ASTNode *tree, SymbolTable *symbol_table);
+int analyze_statements(FlatAST *ast, int first, int end, SymbolTable *symbol_table, int loop_depth);
+int analyze_body(FlatAST *ast, int first, int end, SymbolTable *symbol_table, int loop_depth);
+int analyze_AST(FlatAST *ast, SymbolTable *symbol_table);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spade.string.h"
+
+/**
+ * Hashes a string with 32-bit FNV-1a.
+ *
+ * @param string The bytes to hash
+ * @param length Number of bytes
+ * @return The hash of the string's contents
+ */
+unsigned int hash_string(const char *string, int length) {
+    unsigned int hash = 2166136261u;
+    const unsigned char *p = (const unsigned char *)string;
+    for (int i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Creates and initializes an empty string table.
+ *
+ * @return A pointer to the new table, or NULL on allocation failure
+ */
+StringTable *create_string_table(void) {
+    StringTable *table = malloc(sizeof(StringTable));
+    if (!table) return NULL;
+
+    table->capacity = 16;
+    table->count = 0;
+    table->live_count = 0;
+    table->strings = malloc(sizeof(char *) * table->capacity);
+    table->lengths = malloc(sizeof(int) * table->capacity);
+    table->hashes = malloc(sizeof(unsigned int) * table->capacity);
+    table->free_ids = malloc(sizeof(int) * table->capacity);
+    table->free_count = 0;
+    table->bucket_count = 32;
+    table->buckets = calloc(table->bucket_count, sizeof(int));
+    table->borrowed = 0;
+    if (!table->strings || !table->lengths || !table->hashes || !table->free_ids || !table->buckets) {
+        free(table->strings);
+        free(table->lengths);
+        free(table->hashes);
+        free(table->free_ids);
+        free(table->buckets);
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+/**
+ * Creates a read-only view over strings stored elsewhere.
+ *
+ * The view takes ownership of the strings pointer array but not of the text
+ * it points to or of lengths, which must outlive the view. Views have no
+ * hash index: string_table_get and string_table_length work, interning and
+ * lookups by content do not.
+ *
+ * @param strings Array of count NUL-terminated strings (owned by the view afterwards)
+ * @param lengths Length in bytes of each string (borrowed)
+ * @param count Number of strings
+ * @return A pointer to the new view, or NULL on allocation failure
+ */
+StringTable *create_string_view(char **strings, int *lengths, int count) {
+    StringTable *table = calloc(1, sizeof(StringTable));
+    if (!table) return NULL;
+
+    table->strings = strings;
+    table->lengths = lengths;
+    table->count = count;
+    table->capacity = count;
+    table->live_count = count;
+    table->borrowed = 1;
+    return table;
+}
+
+/**
+ * Finds the bucket that holds a string, or the empty bucket where it belongs.
+ *
+ * Entries are compared by cached hash and length before their bytes, so
+ * most mismatches never touch the string data.
+ *
+ * @param table The string table to search
+ * @param string The bytes to look for
+ * @param length Number of bytes
+ * @param hash The hash of the string
+ * @return Index into table->buckets
+ */
+int find_bucket(StringTable *table, const char *string, int length, unsigned int hash) {
+    unsigned int mask = (unsigned int)table->bucket_count - 1;
+    unsigned int bucket = hash & mask;
+    while (table->buckets[bucket] != 0) {
+        int id = table->buckets[bucket] - 1;
+        if (table->hashes[id] == hash && table->lengths[id] == length &&
+            memcmp(table->strings[id], string, length) == 0) {
+            break;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    return (int)bucket;
+}
+
+/**
+ * Doubles the hash index and re-inserts every interned string.
+ *
+ * @param table The string table to grow
+ * @return 1 on success, 0 on allocation failure
+ */
+int grow_buckets(StringTable *table) {
+    int new_count = table->bucket_count * 2;
+    int *new_buckets = calloc(new_count, sizeof(int));
+    if (!new_buckets) return 0;
+
+    free(table->buckets);
+    table->buckets = new_buckets;
+    table->bucket_count = new_count;
+
+    unsigned int mask = (unsigned int)new_count - 1;
+    for (int i = 0; i < table->count; i++) {
+        if (!table->strings[i]) continue;
+        unsigned int bucket = table->hashes[i] & mask;
+        while (table->buckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        table->buckets[bucket] = i + 1;
+    }
+    return 1;
+}
+
+/**
+ * Grows the per-string arrays to make room for more ids.
+ *
+ * @param table The string table to grow
+ * @return 1 on success, 0 on allocation failure
+ */
+int grow_strings(StringTable *table) {
+    int new_capacity = table->capacity * 2;
+
+    char **new_strings = realloc(table->strings, sizeof(char *) * new_capacity);
+    if (!new_strings) return 0;
+    table->strings = new_strings;
+
+    int *new_lengths = realloc(table->lengths, sizeof(int) * new_capacity);
+    if (!new_lengths) return 0;
+    table->lengths = new_lengths;
+
+    unsigned int *new_hashes = realloc(table->hashes, sizeof(unsigned int) * new_capacity);
+    if (!new_hashes) return 0;
+    table->hashes = new_hashes;
+
+    // Every id can be free at most once, so the free list grows with the ids
+    int *new_free = realloc(table->free_ids, sizeof(int) * new_capacity);
+    if (!new_free) return 0;
+    table->free_ids = new_free;
+
+    table->capacity = new_capacity;
+    return 1;
+}
+
+/**
+ * Looks up a string without adding it.
+ *
+ * @param table The string table to search
+ * @param string The bytes to look for
+ * @param length Number of bytes
+ * @return The string's index, or -1 if it has not been interned
+ */
+int find_string(StringTable *table, const char *string, int length) {
+    int bucket = find_bucket(table, string, length, hash_string(string, length));
+    return table->buckets[bucket] - 1;
+}
+
+/**
+ * Returns the index of a NUL-terminated string, adding a copy of it if it is new.
+ *
+ * @param table The string table to intern into
+ * @param string The string to intern (copied on first use)
+ * @return The string's index, or -1 on allocation failure
+ */
+int intern_string(StringTable *table, const char *string) {
+    return intern_string_length(table, string, strlen(string));
+}
+
+/**
+ * Returns the index of a string, adding a copy of it if it is new.
+ *
+ * Identical strings always map to the same index, so callers can compare
+ * strings by index.
+ *
+ * @param table The string table to intern into
+ * @param string The bytes to intern (copied on first use, may contain NUL bytes)
+ * @param length Number of bytes
+ * @return The string's index, or -1 on allocation failure
+ */
+int intern_string_length(StringTable *table, const char *string, int length) {
+    unsigned int hash = hash_string(string, length);
+    int bucket = find_bucket(table, string, length, hash);
+    if (table->buckets[bucket] != 0) {
+        return table->buckets[bucket] - 1;
+    }
+
+    if (table->free_count == 0 && table->count >= table->capacity && !grow_strings(table)) {
+        return -1;
+    }
+
+    char *copy = malloc(length + 1);
+    if (!copy) return -1;
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+
+    // Keep the load factor at or below one half
+    if ((table->live_count + 1) * 2 > table->bucket_count) {
+        if (!grow_buckets(table)) {
+            free(copy);
+            return -1;
+        }
+        bucket = find_bucket(table, string, length, hash);
+    }
+
+    int index = table->free_count > 0 ? table->free_ids[--table->free_count] : table->count++;
+    table->strings[index] = copy;
+    table->lengths[index] = length;
+    table->hashes[index] = hash;
+    table->buckets[bucket] = index + 1;
+    table->live_count++;
+    return index;
+}
+
+/**
+ * Returns the string stored at an index.
+ *
+ * @param table The string table to read from
+ * @param index The string's index
+ * @return The string, or NULL if the index is out of range
+ */
+const char *string_table_get(StringTable *table, int index) {
+    if (index < 0 || index >= table->count) {
+        return NULL;
+    }
+    return table->strings[index];
+}
+
+/**
+ * Returns the length of the string stored at an index.
+ *
+ * @param table The string table to read from
+ * @param index The string's index
+ * @return The length in bytes, or -1 if there is no string at the index
+ */
+int string_table_length(StringTable *table, int index) {
+    if (index < 0 || index >= table->count || !table->strings[index]) {
+        return -1;
+    }
+    return table->lengths[index];
+}
+
+/**
+ * Removes a string from the table and frees it.
+ *
+ * The string's id goes on the free list and is handed out again by a later
+ * intern_string. The hash index uses backward-shift deletion, so lookups
+ * never have to skip over tombstones.
+ *
+ * @param table The string table to remove from
+ * @param index The id of the string to remove
+ */
+void remove_string(StringTable *table, int index) {
+    if (index < 0 || index >= table->count || !table->strings[index]) return;
+
+    unsigned int mask = (unsigned int)table->bucket_count - 1;
+    unsigned int hole = (unsigned int)find_bucket(table, table->strings[index], table->lengths[index],
+                                                 table->hashes[index]);
+    unsigned int next = hole;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (table->buckets[next] == 0) break;
+
+        // Entries whose home bucket lies cyclically in (hole, next] stay where they are
+        unsigned int home = table->hashes[table->buckets[next] - 1] & mask;
+        int stays = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!stays) {
+            table->buckets[hole] = table->buckets[next];
+            hole = next;
+        }
+    }
+    table->buckets[hole] = 0;
+
+    free(table->strings[index]);
+    table->strings[index] = NULL;
+    table->free_ids[table->free_count++] = index;
+    table->live_count--;
+}
+
+/**
+ * Frees a string table and every string it holds (for a view, only the view itself).
+ *
+ * @param table The string table to free
+ */
+void free_string_table(StringTable *table) {
+    if (!table) return;
+
+    if (table->borrowed) {
+        // A view only owns its pointer array
+        free(table->strings);
+        free(table);
+        return;
+    }
+
+    for (int i = 0; i < table->count; i++) {
+        free(table->strings[i]);
+    }
+    free(table->strings);
+    free(table->lengths);
+    free(table->hashes);
+    free(table->free_ids);
+    free(table->buckets);
+    free(table);
+}
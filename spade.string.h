@@ -0,0 +1,48 @@
+#ifndef SPADE_STRING_H
+#define SPADE_STRING_H
+
+/**
+ * Interned string table.
+ *
+ * Every distinct string is stored once and identified by a dense index, so
+ * two strings are equal exactly when their indices are equal. Used for the
+ * IR's string literals and for the VM's string pool.
+ *
+ * Strings are length-prefixed: each entry records its length and hash, so
+ * no operation needs strlen and strings may contain embedded NUL bytes.
+ * Stored text is still NUL-terminated for printing convenience.
+ *
+ * A table made by create_string_view is a read-only view over strings that
+ * live elsewhere (such as a mapped image): it has no hash index, so it can be
+ * read by id but not searched or interned into.
+ */
+typedef struct {
+    char **strings;         // Interned strings, indexed by string id (NULL once removed)
+    int *lengths;           // Length in bytes of each string
+    unsigned int *hashes;   // Cached hash of each string
+    int count;              // Number of string ids handed out, including removed ones
+    int capacity;           // Allocated capacity for strings
+    int live_count;         // Number of strings currently stored
+
+    int *free_ids;          // Removed string ids, reused before new ones are handed out
+    int free_count;
+
+    int *buckets;           // Open-addressed hash index: string id + 1, or 0 when empty
+    int bucket_count;       // Number of buckets (always a power of two)
+
+    int borrowed;           // 1 for a view: the text and lengths belong to someone else
+} StringTable;
+
+unsigned int hash_string(const char *string, int length);
+
+StringTable *create_string_table(void);
+StringTable *create_string_view(char **strings, int *lengths, int count);
+int find_string(StringTable *table, const char *string, int length);
+int intern_string(StringTable *table, const char *string);
+int intern_string_length(StringTable *table, const char *string, int length);
+const char *string_table_get(StringTable *table, int index);
+int string_table_length(StringTable *table, int index);
+void remove_string(StringTable *table, int index);
+void free_string_table(StringTable *table);
+
+#endif
@@ -3,35 +3,127 @@
 #include <string.h>
 #include "spade.lexer.h"
 #include "spade.symbol.h"
+#include "spade.string.h"
+#include "spade.output.h"
 
 /**
- * Adds a new symbol to the symbol table.
+ * Finds the bucket that holds a name in one scope, or the empty bucket where it belongs.
  *
- * @param table The symbol table to add the symbol to
- * @param name The name of the symbol to be added
- * @param type The token type of the symbol
- * @return 1 if symbol was successfully added, 0 if symbol already exists or table is full
+ * @param table The scope to search (must have a hash index)
+ * @param name The name to look for
+ * @param hash The hash of the name
+ * @return Index into table->buckets
  */
-int add_symbol(SymbolTable *table, const char *name, enum TokenType type) {
-    // check if symbol already exists
-    for(int i = 0; i < table->count; i++){
-        if(strcmp(table->symbols[i]->name, name) == 0){
-            return 0; // return false if symbol already exists
+int find_symbol_bucket(SymbolTable *table, const char *name, unsigned int hash) {
+    unsigned int mask = (unsigned int)table->bucket_count - 1;
+    unsigned int bucket = hash & mask;
+    while (table->buckets[bucket] != 0) {
+        Symbol *symbol = table->symbols[table->buckets[bucket] - 1];
+        if (symbol->hash == hash && strcmp(symbol->name, name) == 0) {
+            break;
         }
+        bucket = (bucket + 1) & mask;
+    }
+    return (int)bucket;
+}
+
+/**
+ * Looks up a name in one scope only, without searching parent scopes.
+ *
+ * @param table The scope to search
+ * @param name The name to look for
+ * @param hash The hash of the name
+ * @return The symbol, or NULL if the scope does not declare the name
+ */
+Symbol *find_local_symbol(SymbolTable *table, const char *name, unsigned int hash) {
+    if (table->bucket_count == 0) return NULL;
+
+    int id = table->buckets[find_symbol_bucket(table, name, hash)];
+    return id ? table->symbols[id - 1] : NULL;
+}
+
+/**
+ * Rebuilds a scope's hash index at twice its size (or its initial size).
+ *
+ * @param table The scope to grow
+ * @return 1 on success, 0 on allocation failure
+ */
+int grow_symbol_buckets(SymbolTable *table) {
+    int new_count = table->bucket_count ? table->bucket_count * 2 : 16;
+    int *new_buckets = calloc(new_count, sizeof(int));
+    if (!new_buckets) return 0;
+
+    free(table->buckets);
+    table->buckets = new_buckets;
+    table->bucket_count = new_count;
+
+    unsigned int mask = (unsigned int)new_count - 1;
+    for (int i = 0; i < table->count; i++) {
+        unsigned int bucket = table->symbols[i]->hash & mask;
+        while (table->buckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        table->buckets[bucket] = i + 1;
+    }
+    return 1;
+}
+
+/**
+ * Appends a new symbol to a scope and indexes it by name.
+ *
+ * The caller has already checked that the scope does not declare the name.
+ *
+ * @param table The scope to add to
+ * @param name The symbol's name (copied)
+ * @param hash The hash of the name
+ * @param type The symbol's type
+ * @return The new symbol, or NULL on allocation failure
+ */
+Symbol *insert_symbol(SymbolTable *table, const char *name, unsigned int hash, enum TokenType type) {
+    if (table->count >= table->capacity) {
+        int new_capacity = table->capacity ? table->capacity * 2 : 8;
+        Symbol **new_symbols = realloc(table->symbols, sizeof(Symbol *) * new_capacity);
+        if (!new_symbols) return NULL;
+        table->symbols = new_symbols;
+        table->capacity = new_capacity;
+    }
+
+    // Keep the load factor at or below one half
+    if ((table->count + 1) * 2 > table->bucket_count && !grow_symbol_buckets(table)) {
+        return NULL;
     }
 
-    // check if table is full
-    if(table->count >= MAX_SYMBOLS) return 0; // return false if table is full
-    // add symbol to table
     Symbol *new_symbol = (Symbol *)malloc(sizeof(Symbol));
+    if (!new_symbol) return NULL;
     new_symbol->name = strdup(name);
     new_symbol->type = type;
     new_symbol->params = NULL;
     new_symbol->param_count = 0;
     new_symbol->param_capacity = 0;
     new_symbol->local_scope = NULL;
+    new_symbol->slot = -1;
+    new_symbol->hash = hash;
+
+    table->buckets[find_symbol_bucket(table, name, hash)] = table->count + 1;
     table->symbols[table->count++] = new_symbol;
-    return 1; // return true if symbol was added successfully
+    return new_symbol;
+}
+
+/**
+ * Adds a new symbol to the symbol table.
+ *
+ * @param table The symbol table to add the symbol to
+ * @param name The name of the symbol to be added
+ * @param type The token type of the symbol
+ * @return 1 if symbol was successfully added, 0 if symbol already exists or memory ran out
+ */
+int add_symbol(SymbolTable *table, const char *name, enum TokenType type) {
+    unsigned int hash = hash_string(name, strlen(name));
+
+    // check if symbol already exists
+    if (find_local_symbol(table, name, hash)) return 0;
+
+    return insert_symbol(table, name, hash, type) != NULL;
 }
 
 /**
@@ -46,33 +138,25 @@ int add_symbol(SymbolTable *table, const char *name, enum TokenType type) {
  * @param type The return type of the function (TOKEN_INT, TOKEN_STRING, etc.)
  * @param params Array of parameters for the function
  * @param param_count Number of parameters in the params array
- * @return 1 if function was successfully added, 0 if function already exists or table is full
+ * @return 1 if function was successfully added, 0 if function already exists or memory ran out
  */
 int add_symbol_function(SymbolTable *table, const char *name, enum TokenType type, Param *params, int param_count) {
-    // check if symbol already exists in local scope
-    for(int i = 0; i < table->count; i++){
-        if(strcmp(table->symbols[i]->name, name) == 0){
-            return 0; // return false if symbol already exists
-        }
-    }
+    unsigned int hash = hash_string(name, strlen(name));
 
-    // check if table is full
-    if(table->count >= MAX_SYMBOLS) return 0; // return false if table is full
+    // check if symbol already exists in local scope
+    if (find_local_symbol(table, name, hash)) return 0;
 
     // create local symbol table and add its parent
-    SymbolTable *local_scope = (SymbolTable *)malloc(sizeof(SymbolTable));
+    SymbolTable *local_scope = (SymbolTable *)calloc(1, sizeof(SymbolTable));
+    if (!local_scope) return 0;
     local_scope->parent = table;
-    local_scope->count = 0;
-    
-    // Initialize all symbol pointers to NULL
-    for(int i = 0; i < MAX_SYMBOLS; i++) {
-        local_scope->symbols[i] = NULL;
-    }
 
     // add symbol to table
-    Symbol *new_symbol = (Symbol *)malloc(sizeof(Symbol));
-    new_symbol->name = strdup(name);
-    new_symbol->type = type;
+    Symbol *new_symbol = insert_symbol(table, name, hash, type);
+    if (!new_symbol) {
+        free(local_scope);
+        return 0;
+    }
     new_symbol->param_count = param_count;
     new_symbol->param_capacity = param_count > 0 ? param_count : 10;
     new_symbol->local_scope = local_scope;
@@ -84,20 +168,40 @@ int add_symbol_function(SymbolTable *table, const char *name, enum TokenType typ
             new_symbol->params[i].name = strdup(params[i].name);  // Deep copy parameter name
             new_symbol->params[i].type = params[i].type;
         }
-    } else {
-        new_symbol->params = NULL;  // No parameters for this function
     }
 
     // Add function parameters to the function's local scope
     for (int i = 0; i < param_count; i++){
         add_symbol(local_scope, params[i].name, params[i].type);
     }
-    table->symbols[table->count++] = new_symbol;
     return 1;
-    
 }
 
 
+/**
+ * Opens a new block scope nested in another scope.
+ *
+ * The new scope is owned by its parent and freed together with it.
+ *
+ * @param parent The enclosing scope
+ * @return The new, empty scope, or NULL if memory ran out
+ */
+SymbolTable *open_scope(SymbolTable *parent){
+    if (parent->scope_count >= parent->scope_capacity) {
+        int new_capacity = parent->scope_capacity ? parent->scope_capacity * 2 : 4;
+        SymbolTable **new_scopes = realloc(parent->scopes, sizeof(SymbolTable *) * new_capacity);
+        if (!new_scopes) return NULL;
+        parent->scopes = new_scopes;
+        parent->scope_capacity = new_capacity;
+    }
+
+    SymbolTable *scope = (SymbolTable *)calloc(1, sizeof(SymbolTable));
+    if (!scope) return NULL;
+    scope->parent = parent;
+    parent->scopes[parent->scope_count++] = scope;
+    return scope;
+}
+
 /**
  * Searches for a symbol in the symbol table by its name.
  *
@@ -106,15 +210,12 @@ int add_symbol_function(SymbolTable *table, const char *name, enum TokenType typ
  * @return A pointer to the Symbol if found, NULL otherwise
  */
 Symbol *lookup_symbol_table(SymbolTable *table, const char *name){
-    // search for symbol in table
-    for(int i = 0; i < table->count; i++){
-        if(strcmp(table->symbols[i]->name, name) == 0){
-            return table->symbols[i]; // return symbol if found
-        }
-    }
+    unsigned int hash = hash_string(name, strlen(name));
 
-    if(table->parent != NULL){
-        return lookup_symbol_table(table->parent, name); // recursively search parent scope
+    // search this scope, then each enclosing scope
+    for (; table != NULL; table = table->parent) {
+        Symbol *symbol = find_local_symbol(table, name, hash);
+        if (symbol) return symbol;
     }
 
     return NULL; // return NULL if symbol not found
@@ -134,28 +235,22 @@ Symbol *lookup_symbol_table(SymbolTable *table, const char *name){
  * @return A pointer to the Symbol if found with matching signature, NULL otherwise
  */
 Symbol *lookup_symbol_table_function(SymbolTable *table, const char *name, Param *params, int param_count){
-    // search for symbol in table
-    int flag = 1;  // Flag to track parameter type matching
-    for(int i = 0; i < table->count; i++){
-        if(strcmp(table->symbols[i]->name, name) == 0){  // Found matching function name
-            if(table->symbols[i]->param_count == param_count){  // Check parameter count match
-                // Check each parameter type for exact match
-                for(int j = 0; j < param_count; j++){
-                    if(table->symbols[i]->params[j].type != params[j].type){
-                        flag = 0;  // Parameter type mismatch
-                        break;
-                    }
-                }
-                if(flag){  // All parameters matched
-                    return table->symbols[i]; // return symbol if found
-                }
+    unsigned int hash = hash_string(name, strlen(name));
+
+    for (; table != NULL; table = table->parent) {
+        // Names are unique within a scope, so at most one candidate per scope
+        Symbol *symbol = find_local_symbol(table, name, hash);
+        if (!symbol || symbol->param_count != param_count) continue;  // Check parameter count match
+
+        // Check each parameter type for exact match
+        int matched = 1;
+        for (int j = 0; j < param_count; j++) {
+            if (symbol->params[j].type != params[j].type) {
+                matched = 0;  // Parameter type mismatch
+                break;
             }
         }
-        flag = 1;  // Reset flag for next symbol
-    }
-
-    if(table->parent != NULL){
-        return lookup_symbol_table_function(table->parent, name, params, param_count); // recursively search parent scope
+        if (matched) return symbol;
     }
     return NULL; // return NULL if symbol not found
 }
@@ -170,9 +265,9 @@ Symbol *lookup_symbol_table_function(SymbolTable *table, const char *name, Param
  * @param table The symbol table to be printed
  */
 void print_symbol_table(SymbolTable *table){
-    printf("Symbol Table:\n");
+    spade_printf("Symbol Table:\n");
     for(int i = 0; i < table->count; i++){
-        printf("%s: %s\n", table->symbols[i]->name, get_token_name(table->symbols[i]->type));
+        spade_printf("%s: %s\n", table->symbols[i]->name, get_token_name(table->symbols[i]->type));
     }
 }
 
@@ -181,7 +276,8 @@ void print_symbol_table(SymbolTable *table){
  * Frees the memory allocated for a symbol table.
  *
  * Iterates through the symbols in the table, freeing the memory 
- * for each symbol's name, parameters, local scope, and the symbol itself.
+ * for each symbol's name, parameters, local scope, and the symbol itself,
+ * and then frees the block scopes nested in the table.
  * Resets the table's symbol count to 0 after freeing.
  *
  * @param table The symbol table to be freed
@@ -213,8 +309,25 @@ void free_symbol_table(SymbolTable *table){
         
         // Free the symbol itself
         free(symbol);
-        table->symbols[i] = NULL;
     }
+    free(table->symbols);
+    free(table->buckets);
+
+    // Free nested block scopes (recursively)
+    for(int i = 0; i < table->scope_count; i++){
+        free_symbol_table(table->scopes[i]);
+        free(table->scopes[i]);
+    }
+    free(table->scopes);
 
+    // Leave an empty table behind so it can be reused
+    table->symbols = NULL;
+    table->buckets = NULL;
+    table->scopes = NULL;
+    table->scope_count = 0;
+    table->scope_capacity = 0;
+    table->capacity = 0;
+    table->bucket_count = 0;
     table->count = 0; // reset the count to 0
+    table->slot_count = 0; // slots are handed out again for the next program
 }
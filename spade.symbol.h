@@ -1,8 +1,6 @@
 #ifndef SPADE_SYM_H
 #define SPADE_SYM_H
 
-#define MAX_SYMBOLS 1024
-
 // Forward declarations
 typedef struct SymbolTable SymbolTable;
 
@@ -18,21 +16,41 @@ typedef struct {
     int param_count;              // Number of parameters (0 for variables)
     int param_capacity;           // Allocated capacity for parameters array
     SymbolTable *local_scope;     // Function's local symbol table (NULL for variables)
+    int slot;                     // VM variable slot (-1 until assigned during IR generation)
+    unsigned int hash;            // Hash of name, compared before the name itself
 } Symbol;
 
+/**
+ * One scope's symbols.
+ *
+ * Symbols are kept in declaration order in a growable array, and an
+ * open-addressing hash index (linear probing, load factor at most one half)
+ * maps names to positions in it. A zero-initialized table is a valid empty
+ * scope; its arrays are allocated on the first insertion.
+ *
+ * Blocks get their own scopes, which stay alive (owned by the enclosing
+ * scope) after analysis so IR generation can resolve names in them again.
+ */
 typedef struct SymbolTable {
-    Symbol *symbols[MAX_SYMBOLS]; // Array of symbol pointers
+    Symbol **symbols;             // Symbols in declaration order
     int count;                    // Number of symbols in this table
+    int capacity;                 // Allocated length of symbols
+    int *buckets;                 // Hash index: 0 = empty, otherwise index into symbols + 1
+    int bucket_count;             // Length of buckets (a power of two, 0 before the first insertion)
     struct SymbolTable *parent;   // Parent scope (NULL for global scope)
+    int slot_count;               // Number of VM slots handed out (tracked on the global scope)
+    struct SymbolTable **scopes;  // Block scopes opened directly inside this one (owned)
+    int scope_count;              // Number of block scopes
+    int scope_capacity;           // Allocated length of scopes
 } SymbolTable;
 
-extern SymbolTable global_symbol_table;
-
 // Symbol table manipulation functions
 int add_symbol(SymbolTable *table, const char *name, enum TokenType type);                    // Add variable symbol
 int add_symbol_function(SymbolTable *table, const char *name, enum TokenType type,          // Add function symbol with parameters
                        Param *params, int param_count);
 
+SymbolTable *open_scope(SymbolTable *parent);                                                // Create a block scope inside parent
+
 // Symbol lookup functions
 Symbol *lookup_symbol_table(SymbolTable *table, const char *name);                          // Find symbol by name
 Symbol *lookup_symbol_table_function(SymbolTable *table, const char *name,                  // Find function by name and signature
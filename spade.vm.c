@@ -4,18 +4,21 @@
 #include <math.h>
 #include <limits.h>
 #include "spade.vm.h"
+#include "spade.bytecode.h"
+#include "spade.output.h"
 
 /**
  * Safe integer power function with overflow detection
  * @param base The base number
  * @param exponent The exponent (must be >= 0)
  * @param result Pointer to store the result
+ * @param report_errors 1 to print the reason a calculation is rejected, 0 to stay silent
  * @return VM_SUCCESS if calculation is safe, VM_INVALID_INSTRUCTION if overflow
  */
-VMResult safe_int_power(int base, int exponent, int *result) {
+VMResult safe_int_power(int base, int exponent, int *result, int report_errors) {
     // Handle edge cases first
     if (exponent < 0) {
-        printf("Error: Negative exponents not supported\n");
+        if (report_errors) spade_printf("Error: Negative exponents not supported\n");
         return VM_INVALID_INSTRUCTION;
     }
     
@@ -23,6 +26,11 @@ VMResult safe_int_power(int base, int exponent, int *result) {
         *result = 1;  // Any number to power 0 is 1
         return VM_SUCCESS;
     }
+
+    if (exponent == 1) {
+        *result = base;  // Every int, INT_MIN included, is its own first power
+        return VM_SUCCESS;
+    }
     
     if (base == 0) {
         *result = 0;  // 0 to any positive power is 0
@@ -41,29 +49,28 @@ VMResult safe_int_power(int base, int exponent, int *result) {
     
     // Set reasonable limits to prevent overflow
     if (exponent > 31) {
-        printf("Error: Exponent %d too large (max 31)\n", exponent);
+        if (report_errors) spade_printf("Error: Exponent %d too large (max 31)\n", exponent);
         return VM_INVALID_INSTRUCTION;
     }
     
-    // Check for potential overflow using simple heuristics
-    if (abs(base) > 2 && exponent > 15) {
-        printf("Error: Power operation would overflow (base=%d, exp=%d)\n", base, exponent);
+    // Check for potential overflow using simple heuristics (abs(INT_MIN) would be undefined)
+    if ((base > 2 || base < -2) && exponent > 15) {
+        if (report_errors) spade_printf("Error: Power operation would overflow (base=%d, exp=%d)\n", base, exponent);
         return VM_INVALID_INSTRUCTION;
     }
     
-    // Perform the calculation with overflow checking
-    *result = 1;
-    int current_base = base;
-    
+    // Perform the calculation in long long, which holds the product of any two ints,
+    // so each step can be range checked after multiplying without overflowing itself
+    long long product = 1;
     for (int i = 0; i < exponent; i++) {
-        // Check if multiplication would overflow
-        if (*result > INT_MAX / abs(current_base)) {
-            printf("Error: Power operation overflow detected\n");
+        product *= base;
+        if (product > INT_MAX || product < INT_MIN) {
+            if (report_errors) spade_printf("Error: Power operation overflow detected\n");
             return VM_INVALID_INSTRUCTION;
         }
-        *result *= current_base;
     }
     
+    *result = (int)product;
     return VM_SUCCESS;
 }
 
@@ -75,35 +82,43 @@ VirtualMachine createVirtualMachine(){
     VirtualMachine vm;
     vm.stack = malloc(sizeof(int) * 100);
     if (!vm.stack) {
-        printf("Error: Failed to allocate stack memory\n");
+        spade_printf("Error: Failed to allocate stack memory\n");
         vm.machine_state = ERROR;
         return vm;
     }
     vm.stack_count = -1;
     vm.stack_capacity = 100;
 
-    vm.variables = malloc(sizeof(Variable) * 10);
+    vm.variables = calloc(10, sizeof(int));
     if (!vm.variables) {
-        printf("Error: Failed to allocate variables memory\n");
+        spade_printf("Error: Failed to allocate variables memory\n");
         free(vm.stack);
         vm.machine_state = ERROR;
         return vm;
     }
 
-    vm.variable_count = -1;
+    vm.variable_names = NULL;
+    vm.slot_is_string = NULL;
+    vm.variable_count = 0;
     vm.variable_capacity = 10;
     
-    vm.string_pool = malloc(sizeof(char *) * 50);
+    vm.string_pool = create_string_table();
     if (!vm.string_pool) {
-        printf("Error: Failed to allocate string pool memory\n");
+        spade_printf("Error: Failed to allocate string pool memory\n");
         free(vm.stack);
         free(vm.variables);
         vm.machine_state = ERROR;
         return vm;
     }
 
-    vm.string_pool_count = 0;
-    vm.string_pool_capacity = 50;
+    vm.literal_indices = NULL;
+    vm.literal_count = 0;
+    vm.ropes = NULL;
+    vm.rope_count = 0;
+    vm.rope_capacity = 0;
+    vm.rope_free = -1;
+    vm.strings_since_gc = 0;
+    vm.gc_threshold = STRING_GC_MIN_THRESHOLD;
 
     vm.program_counter = -1;
     vm.machine_state = RUNNING;
@@ -116,18 +131,18 @@ VirtualMachine createVirtualMachine(){
  * @param vm Pointer to the virtual machine
  */
 void print_VM_state(VirtualMachine *vm){
-    printf("Virtual Machine State:\n");
-    printf("Stack Capacity: %d\n", vm->stack_capacity);
-    printf("Stack Count: %d\n", vm->stack_count);
-    printf("Stack Contents: \n");
+    spade_printf("Virtual Machine State:\n");
+    spade_printf("Stack Capacity: %d\n", vm->stack_capacity);
+    spade_printf("Stack Count: %d\n", vm->stack_count);
+    spade_printf("Stack Contents: \n");
     peek_stack(vm);
-    printf("Variable Capacity: %d\n", vm->variable_capacity);
-    printf("Variable Count: %d\n", vm->variable_count);
-    printf("Variable Contents: \n");
+    spade_printf("Variable Capacity: %d\n", vm->variable_capacity);
+    spade_printf("Variable Count: %d\n", vm->variable_count);
+    spade_printf("Variable Contents: \n");
     peek_variables(vm);
-    printf("String Pool Capacity: %d\n", vm->string_pool_capacity);
-    printf("String Pool Count: %d\n", vm->string_pool_count);
-    printf("String Pool Contents: \n");
+    spade_printf("String Pool Capacity: %d\n", vm->string_pool->capacity);
+    spade_printf("String Pool Count: %d\n", vm->string_pool->live_count);
+    spade_printf("String Pool Contents: \n");
     peek_string_pool(vm);
 }
 
@@ -139,7 +154,7 @@ void print_VM_state(VirtualMachine *vm){
  */
 VMResult push_stack(VirtualMachine *vm, int value){
     if(vm->stack_count == vm->stack_capacity - 1){
-        printf("Stack Overflow\n");
+        spade_printf("Stack Overflow\n");
         return VM_STACK_OVERFLOW;
     }
 
@@ -155,7 +170,7 @@ VMResult push_stack(VirtualMachine *vm, int value){
  */
 VMResult pop_stack(VirtualMachine *vm, int *value){
     if(vm->stack_count == -1){
-        printf("Stack Underflow\n");
+        spade_printf("Stack Underflow\n");
         return VM_STACK_UNDERFLOW;
     }
 
@@ -169,75 +184,66 @@ VMResult pop_stack(VirtualMachine *vm, int *value){
  */
 void peek_stack(VirtualMachine *vm){
     for(int i = 0; i <= vm->stack_count; i++){
-        printf("        %d. %d \n", i + 1, vm->stack[i]);
-    }
-}
-
-Variable *lookup_variable(VirtualMachine *vm, char *name){
-    for(int i = 0; i <= vm->variable_count; i++){
-        if(strcmp(vm->variables[i].name, name) == 0){
-            return &vm->variables[i];
-        }
+        spade_printf("        %d. %d \n", i + 1, vm->stack[i]);
     }
-    return NULL;
-}
-
-int update_variable(VirtualMachine *vm, char *name, int value){
-    Variable *variable = lookup_variable(vm, name);
-    if(variable){
-        variable->value = value;
-        return 1;
-    }
-    return 0;
 }
 
 /**
- * Stores a variable in the VM's variable table
+ * Makes room for the variable slots a program needs
  * @param vm Pointer to the virtual machine
- * @param name Variable name (string will be copied)
- * @param value Integer value to store
+ * @param slot_count Number of variable slots the program uses
  * @return VM_SUCCESS or VM_OUT_OF_MEMORY
  */
-VMResult store_variable(VirtualMachine *vm, char *name, int value){
-    Variable variable;
-    variable.name = strdup(name);
-    if (!variable.name) {
-        return VM_OUT_OF_MEMORY;
-    }
-    variable.value = value;
-
-    if(vm->variable_count >= vm->variable_capacity - 1){
-        vm->variable_capacity *= 2;
-        Variable *new_vars = realloc(vm->variables, sizeof(Variable) * vm->variable_capacity);
+VMResult reserve_variables(VirtualMachine *vm, int slot_count){
+    if(slot_count > vm->variable_capacity){
+        int new_capacity = vm->variable_capacity;
+        while(new_capacity < slot_count){
+            new_capacity *= 2;
+        }
+        int *new_vars = realloc(vm->variables, sizeof(int) * new_capacity);
         if (!new_vars) {
-            free(variable.name);
             return VM_OUT_OF_MEMORY;
         }
+        // Slots start out zeroed so declared-but-unassigned variables read as 0
+        memset(new_vars + vm->variable_capacity, 0, sizeof(int) * (new_capacity - vm->variable_capacity));
         vm->variables = new_vars;
+        vm->variable_capacity = new_capacity;
     }
 
-    if(!update_variable(vm, name, value)){
-        vm->variables[++vm->variable_count] = variable;
+    if(slot_count > vm->variable_count){
+        vm->variable_count = slot_count;
     }
-
     return VM_SUCCESS;
 }
 
 /**
- * Loads a variable value and pushes it onto the stack
+ * Stores a value in a variable slot
  * @param vm Pointer to the virtual machine
- * @param name Variable name to look up
+ * @param slot Slot index assigned to the variable during IR generation
+ * @param value Integer value to store
  * @return VM_SUCCESS or VM_VARIABLE_NOT_FOUND
  */
-VMResult load_variable(VirtualMachine *vm, char *name){
-    for(int i = 0; i <= vm->variable_count; i++){
-        if(strcmp(vm->variables[i].name, name) == 0){
-            push_stack(vm, vm->variables[i].value);
-            return VM_SUCCESS;
-        }
+VMResult store_variable(VirtualMachine *vm, int slot, int value){
+    if(slot < 0 || slot >= vm->variable_count){
+        return VM_VARIABLE_NOT_FOUND;
     }
 
-    return VM_VARIABLE_NOT_FOUND;
+    vm->variables[slot] = value;
+    return VM_SUCCESS;
+}
+
+/**
+ * Loads a variable slot and pushes its value onto the stack
+ * @param vm Pointer to the virtual machine
+ * @param slot Slot index assigned to the variable during IR generation
+ * @return VM_SUCCESS, VM_VARIABLE_NOT_FOUND or VM_STACK_OVERFLOW
+ */
+VMResult load_variable(VirtualMachine *vm, int slot){
+    if(slot < 0 || slot >= vm->variable_count){
+        return VM_VARIABLE_NOT_FOUND;
+    }
+
+    return push_stack(vm, vm->variables[slot]);
 }
 
 /**
@@ -251,28 +257,28 @@ void free_VM(VirtualMachine *vm){
     }
 
     if(vm->string_pool){
-        for(int i = 0; i < vm->string_pool_count; i++){
-            if(vm->string_pool[i]){
-                free(vm->string_pool[i]);
-            }
-        }
-        free(vm->string_pool);
+        free_string_table(vm->string_pool);
         vm->string_pool = NULL;
     }
+    free(vm->literal_indices);
+    vm->literal_indices = NULL;
+    vm->literal_count = 0;
+    free(vm->ropes);
+    vm->ropes = NULL;
+    vm->rope_count = 0;
+    vm->rope_capacity = 0;
+    vm->rope_free = -1;
     
     if (vm->variables) {
-        // Free variable names
-        for (int i = 0; i <= vm->variable_count; i++) {
-            if (vm->variables[i].name) {
-                free(vm->variables[i].name);
-            }
-        }
+        // Slot names belong to the IR code, only the slot array is ours
         free(vm->variables);
         vm->variables = NULL;
     }
+    vm->variable_names = NULL;
+    vm->slot_is_string = NULL;
     
     vm->stack_count = -1;
-    vm->variable_count = -1;
+    vm->variable_count = 0;
     vm->program_counter = -1;
     vm->machine_state = HALTED;
 }
@@ -286,78 +292,743 @@ void free_VM(VirtualMachine *vm){
  * @param vm Pointer to the virtual machine
  */
 void peek_variables(VirtualMachine *vm){
-    for(int i = 0; i <= vm->variable_count; i++){
-        printf("        %d. %s = %d\n", i + 1, vm->variables[i].name, vm->variables[i].value);
+    for(int i = 0; i < vm->variable_count; i++){
+        if(vm->variable_names && vm->variable_names[i]){
+            spade_printf("        %d. %s = %d\n", i + 1, vm->variable_names[i], vm->variables[i]);
+        }else{
+            spade_printf("        %d. <slot %d> = %d\n", i + 1, i, vm->variables[i]);
+        }
     }
 }
 
 
 /**
- * Stores a string in the VM's string pool and pushes its index onto the stack.
+ * Stores a string in the VM's string pool.
  * 
- * Adds a string to the string pool, automatically expanding capacity if needed.
- * The string is duplicated and stored, then its index is pushed onto the stack.
- * This allows the VM to handle string literals efficiently.
+ * The pool interns its strings: storing text that is already in the pool
+ * returns the existing index instead of adding a copy, so repeated literals
+ * and concatenations do not grow the pool and two strings are equal exactly
+ * when their indices are equal.
  * 
  * @param vm Pointer to the virtual machine
- * @param string The string to store in the pool
+ * @param string The bytes to store in the pool (copied if new)
+ * @param length Number of bytes
+ * @param index Pointer to store the pool index of the string
  * @return VM_SUCCESS on success, VM_OUT_OF_MEMORY on allocation failure
  */
-VMResult store_string(VirtualMachine *vm, char *string){
-    if(vm->string_pool_count >= vm->string_pool_capacity - 1){
-        vm->string_pool_capacity *= 2;
-        char **new_pool = realloc(vm->string_pool, sizeof(char *) * vm->string_pool_capacity);
-        if (!new_pool) {
-            return VM_OUT_OF_MEMORY;
+VMResult store_string(VirtualMachine *vm, const char *string, int length, int *index){
+    int interned = intern_string_length(vm->string_pool, string, length);
+    if(interned < 0){
+        return VM_OUT_OF_MEMORY;
+    }
+    *index = interned;
+    return VM_SUCCESS;
+}  
+
+/**
+ * Growable stack of string values, used to walk ropes without recursion.
+ */
+typedef struct {
+    int *values;
+    int count;
+    int capacity;
+} ValueStack;
+
+/**
+ * Pushes a value onto a ValueStack, growing it when needed.
+ * 
+ * @param stack The stack to push onto
+ * @param value The value to push
+ * @return 1 on success, 0 on allocation failure
+ */
+int value_stack_push(ValueStack *stack, int value){
+    if(stack->count >= stack->capacity){
+        int new_capacity = stack->capacity > 0 ? stack->capacity * 2 : 32;
+        int *new_values = realloc(stack->values, sizeof(int) * new_capacity);
+        if(!new_values){
+            return 0;
         }
-        vm->string_pool = new_pool;
+        stack->values = new_values;
+        stack->capacity = new_capacity;
     }
+    stack->values[stack->count++] = value;
+    return 1;
+}
 
-    vm->string_pool[vm->string_pool_count] = strdup(string);
-    push_stack(vm, vm->string_pool_count);
-    vm->string_pool_count++;
+/**
+ * Looks up the rope node a string value refers to.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param value A string value
+ * @return The live rope node, or NULL if the value is not a rope
+ */
+RopeNode *rope_node(VirtualMachine *vm, int value){
+    if(value >= 0){
+        return NULL;
+    }
+    int node = ROPE_NODE(value);
+    if(node >= vm->rope_count || vm->ropes[node].length < 0){
+        return NULL;
+    }
+    return &vm->ropes[node];
+}
+
+/**
+ * Returns the length of a string value in bytes.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param value A pool index or rope value
+ * @param length Pointer to store the length
+ * @return VM_SUCCESS, or VM_INDEX_OUT_OF_BOUNDS if the value is not a string
+ */
+VMResult string_value_length(VirtualMachine *vm, int value, int *length){
+    RopeNode *node = rope_node(vm, value);
+    if(node){
+        *length = node->length;
+        return VM_SUCCESS;
+    }
+
+    *length = string_table_length(vm->string_pool, value);
+    if(*length < 0){
+        return VM_INDEX_OUT_OF_BOUNDS;
+    }
     return VM_SUCCESS;
-}  
+}
+
+/**
+ * Copies the bytes of a string value into a buffer.
+ * 
+ * Ropes are walked with an explicit stack, so long concatenation chains
+ * cannot overflow the C stack. Already flattened rope nodes are copied from
+ * their flat text in one piece.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param value A pool index or rope value
+ * @param dest Buffer with room for the value's length (not NUL-terminated here)
+ * @return VM_SUCCESS, VM_INDEX_OUT_OF_BOUNDS or VM_OUT_OF_MEMORY
+ */
+VMResult copy_string_value(VirtualMachine *vm, int value, char *dest){
+    ValueStack pending = { NULL, 0, 0 };
+    VMResult result = VM_SUCCESS;
+    int offset = 0;
+
+    if(!value_stack_push(&pending, value)){
+        return VM_OUT_OF_MEMORY;
+    }
+    while(pending.count > 0){
+        int current = pending.values[--pending.count];
+        RopeNode *node = rope_node(vm, current);
+        if(node && node->flat < 0){
+            // Push right first so the left part is copied first
+            if(!value_stack_push(&pending, node->right) || !value_stack_push(&pending, node->left)){
+                result = VM_OUT_OF_MEMORY;
+                break;
+            }
+            continue;
+        }
+
+        int flat = node ? node->flat : current;
+        int length = string_table_length(vm->string_pool, flat);
+        if(length < 0){
+            result = VM_INDEX_OUT_OF_BOUNDS;
+            break;
+        }
+        memcpy(dest + offset, string_table_get(vm->string_pool, flat), length);
+        offset += length;
+    }
+
+    free(pending.values);
+    return result;
+}
 
 /**
- * Loads a string from the VM's string pool by index.
+ * Returns the pool index holding the contiguous text of a string value.
  * 
- * Retrieves a string from the string pool using its index. The string pointer
- * is returned through the output parameter. Performs bounds checking to ensure
- * the index is valid.
+ * Pool indices are returned as they are. A rope is flattened once, interned,
+ * and the result is remembered on the node so later calls are O(1).
  * 
  * @param vm Pointer to the virtual machine
- * @param index Index of the string to retrieve from the pool
+ * @param value A pool index or rope value
+ * @param index Pointer to store the pool index
+ * @return VM_SUCCESS, VM_INDEX_OUT_OF_BOUNDS or VM_OUT_OF_MEMORY
+ */
+VMResult flatten_string(VirtualMachine *vm, int value, int *index){
+    RopeNode *node = rope_node(vm, value);
+    if(!node){
+        if(!string_table_get(vm->string_pool, value)){
+            return VM_INDEX_OUT_OF_BOUNDS;
+        }
+        *index = value;
+        return VM_SUCCESS;
+    }
+    if(node->flat >= 0){
+        *index = node->flat;
+        return VM_SUCCESS;
+    }
+
+    char *buffer = malloc(node->length + 1);
+    if(!buffer){
+        return VM_OUT_OF_MEMORY;
+    }
+    VMResult result = copy_string_value(vm, value, buffer);
+    if(result == VM_SUCCESS){
+        buffer[node->length] = '\0';
+        int live_before = vm->string_pool->live_count;
+        result = store_string(vm, buffer, node->length, index);
+        vm->strings_since_gc += vm->string_pool->live_count - live_before;
+    }
+    free(buffer);
+
+    if(result == VM_SUCCESS){
+        node->flat = *index;
+    }
+    return result;
+}
+
+/**
+ * Loads a string from the VM by value.
+ * 
+ * Retrieves the contiguous text of a pool index or rope, flattening the rope
+ * if needed. Performs bounds checking to ensure the value is valid.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param index Pool index or rope value of the string to retrieve
  * @param string Pointer to store the retrieved string
  * @return VM_SUCCESS on success, VM_INDEX_OUT_OF_BOUNDS on invalid index
  */
-VMResult load_string(VirtualMachine *vm, int index, char **string){
-    if(index >= vm->string_pool_count || index < 0){
-        printf("Error: String stack index out of bounds\n");
+VMResult load_string(VirtualMachine *vm, int index, const char **string){
+    int flat;
+    VMResult result = flatten_string(vm, index, &flat);
+    if(result != VM_SUCCESS){
+        spade_printf("Error: String stack index out of bounds\n");
+        return result == VM_OUT_OF_MEMORY ? VM_OUT_OF_MEMORY : VM_INDEX_OUT_OF_BOUNDS;
+    }
+
+    *string = string_table_get(vm->string_pool, flat);
+    return VM_SUCCESS;
+}
+
+/**
+ * Compares two string values for equality.
+ * 
+ * Pool strings are interned, so two pool indices are equal exactly when
+ * their texts are. Ropes are flattened to their pool index first.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param left The left string value
+ * @param right The right string value
+ * @param equal Pointer to store 1 if the strings are equal, 0 otherwise
+ * @return VM_SUCCESS, VM_INDEX_OUT_OF_BOUNDS or VM_OUT_OF_MEMORY
+ */
+VMResult compare_strings(VirtualMachine *vm, int left, int right, int *equal){
+    if(left == right){
+        *equal = 1;
+        return VM_SUCCESS;
+    }
+
+    int left_flat, right_flat;
+    VMResult result = flatten_string(vm, left, &left_flat);
+    if(result == VM_SUCCESS){
+        result = flatten_string(vm, right, &right_flat);
+    }
+    if(result != VM_SUCCESS){
+        spade_printf("Error: Failed to load strings for comparison\n");
+        return result;
+    }
+    *equal = left_flat == right_flat;
+    return VM_SUCCESS;
+}
+
+/**
+ * Replaces rope values in string variables with their flattened pool index.
+ * 
+ * Called when a program halts, so the final VM state (and anything reading
+ * variables afterwards) sees ordinary pool indices.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @return VM_SUCCESS or the error raised while flattening
+ */
+VMResult flatten_string_slots(VirtualMachine *vm){
+    if(!vm->slot_is_string){
+        return VM_SUCCESS;
+    }
+    for(int i = 0; i < vm->variable_count; i++){
+        if(vm->slot_is_string[i] && rope_node(vm, vm->variables[i])){
+            VMResult result = flatten_string(vm, vm->variables[i], &vm->variables[i]);
+            if(result != VM_SUCCESS){
+                return result;
+            }
+        }
+    }
+    return VM_SUCCESS;
+}
+
+/**
+ * Interns the string literals of a program into the VM's string pool.
+ * 
+ * Done once before execution, so pushing a literal is a table lookup
+ * instead of a copy, no matter how often it runs.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param literals The program's string literal table
+ * @return VM_SUCCESS on success, VM_OUT_OF_MEMORY on allocation failure
+ */
+VMResult load_string_literals(VirtualMachine *vm, StringTable *literals){
+    int *indices = realloc(vm->literal_indices, sizeof(int) * (literals->count > 0 ? literals->count : 1));
+    if(!indices){
+        return VM_OUT_OF_MEMORY;
+    }
+    vm->literal_indices = indices;
+    vm->literal_count = literals->count;
+
+    for(int i = 0; i < literals->count; i++){
+        if(store_string(vm, literals->strings[i], literals->lengths[i], &vm->literal_indices[i]) != VM_SUCCESS){
+            spade_printf("Error: Failed to store string %s in Virtual Machine\n", literals->strings[i]);
+            return VM_OUT_OF_MEMORY;
+        }
+    }
+    return VM_SUCCESS;
+}
+
+/**
+ * Marks a string value and everything it references as reachable.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param string_marks Mark byte per pool id
+ * @param rope_marks Mark byte per rope node
+ * @param pending Work list of rope values whose children still need marking
+ * @param value A value that may be a pool index or rope
+ * @return 1 on success, 0 if the work list could not grow
+ */
+int mark_string(VirtualMachine *vm, unsigned char *string_marks, unsigned char *rope_marks,
+                ValueStack *pending, int value){
+    if(value >= 0){
+        if(value < vm->string_pool->count && vm->string_pool->strings[value]){
+            string_marks[value] = 1;
+        }
+        return 1;
+    }
+
+    if(!rope_node(vm, value) || rope_marks[ROPE_NODE(value)]){
+        return 1;
+    }
+    rope_marks[ROPE_NODE(value)] = 1;
+    return value_stack_push(pending, value);
+}
+
+/**
+ * Frees every string and rope node that the running program can no longer reach.
+ * 
+ * Mark-sweep collection. The roots are the program's string literals (pinned
+ * for the whole run), every value on the stack, the variable slots declared
+ * as string, any registers past the variable slots (register tier
+ * temporaries) and the caller's extra roots. Stack values and registers carry
+ * no type, so they are scanned conservatively: an integer that happens to be
+ * a valid index keeps that string alive, which is safe. Freed pool ids and
+ * rope nodes go on free lists and are reused by later strings.
+ * 
+ * @param vm Pointer to the virtual machine (stack_count must be current)
+ * @param extra_roots Values that must stay alive but are not on the stack
+ * @param extra_count Number of extra roots
+ * @return The number of strings and rope nodes freed
+ */
+int collect_strings(VirtualMachine *vm, const int *extra_roots, int extra_count){
+    StringTable *pool = vm->string_pool;
+    unsigned char *string_marks = calloc(pool->count > 0 ? pool->count : 1, 1);
+    unsigned char *rope_marks = calloc(vm->rope_count > 0 ? vm->rope_count : 1, 1);
+    ValueStack pending = { NULL, 0, 0 };
+    int ok = string_marks && rope_marks;
+
+    for(int i = 0; ok && i < vm->literal_count; i++){
+        ok = mark_string(vm, string_marks, rope_marks, &pending, vm->literal_indices[i]);
+    }
+    for(int i = 0; ok && i <= vm->stack_count; i++){
+        ok = mark_string(vm, string_marks, rope_marks, &pending, vm->stack[i]);
+    }
+    for(int i = 0; ok && i < vm->variable_capacity; i++){
+        if(i < vm->variable_count && vm->slot_is_string && !vm->slot_is_string[i]){
+            continue;
+        }
+        ok = mark_string(vm, string_marks, rope_marks, &pending, vm->variables[i]);
+    }
+    for(int i = 0; ok && i < extra_count; i++){
+        ok = mark_string(vm, string_marks, rope_marks, &pending, extra_roots[i]);
+    }
+    while(ok && pending.count > 0){
+        RopeNode *node = rope_node(vm, pending.values[--pending.count]);
+        ok = mark_string(vm, string_marks, rope_marks, &pending, node->left) &&
+             mark_string(vm, string_marks, rope_marks, &pending, node->right) &&
+             (node->flat < 0 || mark_string(vm, string_marks, rope_marks, &pending, node->flat));
+    }
+
+    int freed = 0;
+    if(ok){
+        for(int i = 0; i < pool->count; i++){
+            if(pool->strings[i] && !string_marks[i]){
+                remove_string(pool, i);
+                freed++;
+            }
+        }
+        for(int i = 0; i < vm->rope_count; i++){
+            if(vm->ropes[i].length >= 0 && !rope_marks[i]){
+                vm->ropes[i].length = -1;
+                vm->ropes[i].left = vm->rope_free;
+                vm->rope_free = i;
+                freed++;
+            }
+        }
+    }
+    // Collection is an optimization, running out of memory here is not fatal
+    free(string_marks);
+    free(rope_marks);
+    free(pending.values);
+
+    vm->strings_since_gc = 0;
+    int live = pool->live_count + vm->rope_count;
+    vm->gc_threshold = live > STRING_GC_MIN_THRESHOLD ? live : STRING_GC_MIN_THRESHOLD;
+    return freed;
+}
+
+/**
+ * Allocates a rope node for the concatenation of two string values.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param left The left string value
+ * @param right The right string value
+ * @param length Total length of the concatenation
+ * @param value Pointer to store the rope value
+ * @return VM_SUCCESS or VM_OUT_OF_MEMORY
+ */
+VMResult new_rope(VirtualMachine *vm, int left, int right, int length, int *value){
+    int node;
+    if(vm->rope_free >= 0){
+        node = vm->rope_free;
+        vm->rope_free = vm->ropes[node].left;
+    }else{
+        if(vm->rope_count >= vm->rope_capacity){
+            int new_capacity = vm->rope_capacity > 0 ? vm->rope_capacity * 2 : 64;
+            RopeNode *new_ropes = realloc(vm->ropes, sizeof(RopeNode) * new_capacity);
+            if(!new_ropes){
+                return VM_OUT_OF_MEMORY;
+            }
+            vm->ropes = new_ropes;
+            vm->rope_capacity = new_capacity;
+        }
+        node = vm->rope_count++;
+    }
+
+    vm->ropes[node].left = left;
+    vm->ropes[node].right = right;
+    vm->ropes[node].length = length;
+    vm->ropes[node].flat = -1;
+    vm->strings_since_gc++;
+    *value = ROPE_VALUE(node);
+    return VM_SUCCESS;
+}
+
+/**
+ * Concatenates two string values.
+ * 
+ * Short results are built directly and interned in the pool. Results of
+ * ROPE_MIN_LENGTH bytes or more become a rope node that only references its
+ * two parts, so concatenation costs O(1) no matter how long the strings
+ * are, and building a string piece by piece is linear instead of quadratic.
+ * Ropes are flattened later, only when contiguous text is needed.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param left_idx String value of the left operand
+ * @param right_idx String value of the right operand
+ * @param index Pointer to store the string value of the result
+ * @return VM_SUCCESS, VM_INDEX_OUT_OF_BOUNDS or VM_OUT_OF_MEMORY
+ */
+VMResult concat_strings(VirtualMachine *vm, int left_idx, int right_idx, int *index){
+    // Reclaim dead strings before the pool grows further; both operands stay alive
+    if(vm->strings_since_gc >= vm->gc_threshold){
+        int operands[2] = { left_idx, right_idx };
+        collect_strings(vm, operands, 2);
+    }
+
+    int left_len, right_len;
+    if(string_value_length(vm, left_idx, &left_len) != VM_SUCCESS ||
+       string_value_length(vm, right_idx, &right_len) != VM_SUCCESS){
+        spade_printf("Error: Failed to load strings for concatenation\n");
         return VM_INDEX_OUT_OF_BOUNDS;
     }
 
-    *string = vm->string_pool[index];
+    // Lengths are ints and buffers hold a terminating NUL, so the result must stay below INT_MAX
+    if(left_len > INT_MAX - 1 - right_len){
+        spade_printf("Error: String concatenation result is too long\n");
+        return VM_OUT_OF_MEMORY;
+    }
+
+    if(left_len + right_len >= ROPE_MIN_LENGTH){
+        if(new_rope(vm, left_idx, right_idx, left_len + right_len, index) != VM_SUCCESS){
+            spade_printf("Error: Failed to allocate memory for string concatenation\n");
+            return VM_OUT_OF_MEMORY;
+        }
+        return VM_SUCCESS;
+    }
+    
+    // Short result: build it contiguously
+    char *result = malloc(left_len + right_len + 1);
+    if (!result) {
+        spade_printf("Error: Failed to allocate memory for string concatenation\n");
+        return VM_OUT_OF_MEMORY;
+    }
+    if(copy_string_value(vm, left_idx, result) != VM_SUCCESS ||
+       copy_string_value(vm, right_idx, result + left_len) != VM_SUCCESS){
+        spade_printf("Error: Failed to load strings for concatenation\n");
+        free(result);
+        return VM_INDEX_OUT_OF_BOUNDS;
+    }
+    result[left_len + right_len] = '\0';
+    
+    // Store the result in the string pool
+    int live_before = vm->string_pool->live_count;
+    if(store_string(vm, result, left_len + right_len, index) != VM_SUCCESS){
+        spade_printf("Error: Failed to store concatenated string\n");
+        free(result);
+        return VM_OUT_OF_MEMORY;
+    }
+    
+    // Free the temporary result string (it's been copied by store_string)
+    free(result);
+    vm->strings_since_gc += vm->string_pool->live_count - live_before;
     return VM_SUCCESS;
 }
 
 /**
  * Prints all strings currently stored in the VM's string pool.
  * 
- * Displays each string with its index in a formatted list.
+ * Displays each live string with its index in a formatted list.
  * Used for debugging and VM state inspection.
  * 
  * @param vm Pointer to the virtual machine
  */
 void peek_string_pool(VirtualMachine *vm){
-    for(int i = 0; i < vm->string_pool_count; i++){
-        printf("        %d. %s\n", i + 1, vm->string_pool[i]);
+    for(int i = 0; i < vm->string_pool->count; i++){
+        if(vm->string_pool->strings[i]){
+            spade_printf("        %d. ", i + 1);
+            fwrite(vm->string_pool->strings[i], 1, vm->string_pool->lengths[i], spade_stdout());
+            spade_printf("\n");
+        }
+    }
+}
+
+
+/**
+ * Verifies IR code once before it is executed.
+ * 
+ * The VM runs the packed bytecode, so that is what gets checked (code that
+ * has not been packed yet is packed first). The instructions are decoded
+ * with their stack effects to prove that every operand is well formed, that
+ * the code never pops from an empty stack, that every opcode is valid, that
+ * every variable slot and string literal index is in range and that the
+ * code ends with IR_HALT.
+ * 
+ * Control flow only ever changes between statements, so instead of merging
+ * stack states along every path the verifier requires the stack to be empty
+ * after each jump and where each jump lands, and every target to be the
+ * start of an instruction. The straight-line depth computed in program order
+ * is then valid on every path. The maximum stack depth is reported so the VM can
+ * size its stack up front, and remembered in verified_depth so the code is
+ * only walked once. Code that passes can be run without per-instruction
+ * checks.
+ * 
+ * @param ir_code Pointer to the IR code to verify
+ * @param max_stack_depth Pointer to store the deepest stack the code reaches
+ * @param report_errors Whether to print the reason code is rejected
+ * @return VM_SUCCESS if the code is safe to run, or the error it would raise
+ */
+VMResult verify_ir_code(IRCode *ir_code, int *max_stack_depth, int report_errors){
+    int depth = 0;
+    *max_stack_depth = 0;
+
+    if(!ir_code->bytecode && !pack_ir_code(ir_code)){
+        if(report_errors) spade_printf("Error: IR code could not be packed into bytecode\n");
+        return VM_INVALID_INSTRUCTION;
+    }
+
+    const unsigned char *bytes = ir_code->bytecode;
+    int size = ir_code->bytecode_size;
+    IRInstruction decoded;
+    IRInstruction *instr = &decoded;
+    int last_opcode = -1;
+    int jump_count = 0;
+
+    // Per bytecode offset: VERIFY_START at an opcode byte, plus VERIFY_EMPTY if the stack is empty there
+    enum { VERIFY_START = 1, VERIFY_EMPTY = 2 };
+    unsigned char *marks = calloc(size ? size : 1, 1);
+    if(!marks){
+        if(report_errors) spade_printf("Error: Out of memory verifying IR code\n");
+        return VM_OUT_OF_MEMORY;
+    }
+
+    for(int i = 0, offset = 0; offset < size; i++){
+        marks[offset] = depth == 0 ? VERIFY_START | VERIFY_EMPTY : VERIFY_START;
+        if(bytes[offset] > IR_HALT){
+            if(report_errors) spade_printf("Error: Invalid opcode %d at instruction %d\n", bytes[offset], i);
+            free(marks);
+            return VM_INVALID_INSTRUCTION;
+        }
+        offset = decode_ir_instruction(bytes, size, offset, instr);
+        if(offset < 0){
+            if(report_errors) spade_printf("Error: Malformed operand at instruction %d\n", i);
+            free(marks);
+            return VM_INVALID_INSTRUCTION;
+        }
+        last_opcode = instr->opcode;
+
+        if(instr->opcode == IR_PUSH_VAR || instr->opcode == IR_STORE_VAR){
+            if(instr->operand.slot < 0 || instr->operand.slot >= ir_code->slot_count){
+                if(report_errors) spade_printf("Error: Instruction %d uses unresolved variable slot %d\n", i, instr->operand.slot);
+                free(marks);
+                return VM_VARIABLE_NOT_FOUND;
+            }
+        }
+
+        if(instr->opcode == IR_PUSH_STRING_LIT){
+            if(instr->operand.int_value < 0 || instr->operand.int_value >= ir_code->strings->count){
+                if(report_errors) spade_printf("Error: Instruction %d uses unknown string literal %d\n", i, instr->operand.int_value);
+                free(marks);
+                return VM_INDEX_OUT_OF_BOUNDS;
+            }
+        }
+
+        if(instr->opcode == IR_ADD_VAR_CONST || instr->opcode == IR_INC_VAR){
+            if(instr->operand.var_const.slot < 0 || instr->operand.var_const.slot >= ir_code->slot_count){
+                if(report_errors) spade_printf("Error: Instruction %d uses unresolved variable slot %d\n", i, instr->operand.var_const.slot);
+                free(marks);
+                return VM_VARIABLE_NOT_FOUND;
+            }
+        }
+
+        if(instr->opcode >= IR_EQ_VAR_VAR && instr->opcode <= IR_LE_VAR_VAR){
+            int left = instr->operand.var_pair.left;
+            int right = instr->operand.var_pair.right;
+            if(left < 0 || left >= ir_code->slot_count || right < 0 || right >= ir_code->slot_count){
+                if(report_errors) spade_printf("Error: Instruction %d uses unresolved variable slot %d\n", i,
+                       (left < 0 || left >= ir_code->slot_count) ? left : right);
+                free(marks);
+                return VM_VARIABLE_NOT_FOUND;
+            }
+        }
+
+        int pops, pushes;
+        ir_stack_effect(instr->opcode, &pops, &pushes);
+        if(depth < pops){
+            if(report_errors) spade_printf("Error: Stack underflow at instruction %d\n", i);
+            free(marks);
+            return VM_STACK_UNDERFLOW;
+        }
+        depth += pushes - pops;
+        if(depth > *max_stack_depth){
+            *max_stack_depth = depth;
+        }
+
+        if(instr->opcode >= IR_JUMP && instr->opcode <= IR_JUMP_IF_TRUE){
+            if(depth != 0){
+                if(report_errors) spade_printf("Error: Jump with a non-empty stack at instruction %d\n", i);
+                free(marks);
+                return VM_INVALID_INSTRUCTION;
+            }
+            jump_count++;
+        }
+    }
+
+    if(last_opcode != IR_HALT){
+        if(report_errors) spade_printf("Error: IR code must end with HALT\n");
+        free(marks);
+        return VM_INVALID_INSTRUCTION;
     }
+
+    // Targets can point forward, so they are checked once every instruction has been marked
+    for(int i = 0, offset = 0; jump_count > 0 && offset < size; i++){
+        offset = decode_ir_instruction(bytes, size, offset, instr);
+        if(instr->opcode < IR_JUMP || instr->opcode > IR_JUMP_IF_TRUE) continue;
+
+        int target = instr->operand.target;
+        if(target < 0 || target >= size || !(marks[target] & VERIFY_START)){
+            if(report_errors) spade_printf("Error: Instruction %d jumps to invalid offset %d\n", i, target);
+            free(marks);
+            return VM_INVALID_INSTRUCTION;
+        }
+        if(!(marks[target] & VERIFY_EMPTY)){
+            if(report_errors) spade_printf("Error: Instruction %d jumps to offset %d with a non-empty stack\n", i, target);
+            free(marks);
+            return VM_INVALID_INSTRUCTION;
+        }
+        jump_count--;
+    }
+    free(marks);
+
+    ir_code->verified_depth = *max_stack_depth;
+    return VM_SUCCESS;
 }
 
+/**
+ * Selects the dispatch engine used by execute_ir_code.
+ *
+ * With GCC/Clang the interpreter is threaded: every handler jumps straight to
+ * the next handler through a table of label addresses (labels-as-values), so
+ * there is no central switch and no per-instruction loop condition. Other
+ * compilers fall back to a portable switch. Build with
+ * -DSPADE_COMPUTED_GOTO=0 to force the switch.
+ */
+#ifndef SPADE_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define SPADE_COMPUTED_GOTO 1
+#else
+#define SPADE_COMPUTED_GOTO 0
+#endif
+#endif
+
+#if SPADE_COMPUTED_GOTO
+#define VM_CASE(op) label_##op:
+#define VM_DISPATCH() goto *dispatch_table[*pc++]
+#define VM_NEXT() VM_DISPATCH()
+#else
+#define VM_CASE(op) case op:
+#define VM_NEXT() continue
+#endif
+
+// Operand readers; each handler reads its operands right after its opcode byte
+#define VM_READ_SLOT(var) BYTECODE_READ_UINT(pc, var)
+#define VM_READ_INT(var) BYTECODE_READ_INT(pc, var)
+#define VM_READ_TARGET(var) BYTECODE_READ_UINT(pc, var)
+
+// Unchecked stack access; verify_ir_code has proven these never under/overflow
+// (sp points one past the top of the stack)
+#define VM_PUSH(value) (*sp++ = (value))
+#define VM_POP() (*--sp)
+#define VM_TOP() (sp[-1])
+
+// Writes the cached registers back so the VM state reflects where execution stopped
+#define VM_SYNC() do { \
+        vm->program_counter = (int)(pc - ir_code->bytecode); \
+        vm->stack_count = (int)(sp - vm->stack) - 1; \
+    } while (0)
+
+#define VM_ERROR(result) do { \
+        VM_SYNC(); \
+        vm->machine_state = ERROR; \
+        return (result); \
+    } while (0)
 
 /**
  * Executes IR code on the virtual machine
+ * 
+ * The code is checked once by verify_ir_code, after which the stack is sized
+ * to the verified maximum depth and the dispatch loop reads and writes it
+ * directly: no bounds checks on push/pop, variable slots or the program
+ * counter. Only value-dependent errors (division by zero, power overflow,
+ * bad string indices) are still checked while running.
+ *
+ * The loop runs the packed bytecode (see spade.bytecode.h) rather than the
+ * IRInstruction array, so straight-line code takes a few bytes per
+ * instruction of cache instead of sizeof(IRInstruction). The program
+ * counter is a byte offset into it.
+ * 
  * @param vm Pointer to the virtual machine
  * @param ir_code Pointer to the IR code to execute
  * @return VM_SUCCESS or appropriate error code
@@ -365,393 +1036,543 @@ void peek_string_pool(VirtualMachine *vm){
 VMResult execute_ir_code(VirtualMachine *vm, IRCode *ir_code){
     vm->program_counter = 0;
     vm->machine_state = RUNNING;
-    
-    while (vm->machine_state == RUNNING && vm->program_counter < ir_code->count) {
-        IRInstruction *instr = &ir_code->instructions[vm->program_counter];
-        
-        switch (instr->opcode) {
-            case IR_PUSH_CONST:
-                // TODO: Implement push constant
-                if(push_stack(vm, instr->operand.int_value) != VM_SUCCESS){
-                    printf("Error: Failed to push constant %d unto stack\n", instr->operand.int_value);
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
 
-                break;
-                
-            case IR_PUSH_STRING_LIT:
-                // Push string index onto stack
-                if(store_string(vm, instr->operand.string_lit) != VM_SUCCESS){
-                    printf("Error: Failed to store string %s in Virtual Machine\n", instr->operand.string_lit);
-                    vm->machine_state = ERROR;
-                    return VM_OUT_OF_MEMORY;
-                }
-                break;
-                
-            case IR_PUSH_VAR:
-                // TODO: Implement push variable
-                if(load_variable(vm, instr->operand.var_name) != VM_SUCCESS){
-                    printf("Error: Failed to load variable %s\n", instr->operand.var_name);
-                    vm->machine_state = ERROR;
-                    return VM_VARIABLE_NOT_FOUND;
-                }
-                break;
-                
-            case IR_STORE_VAR: {
-                // TODO: Implement store variable
+    // Code the driver already verified (an image, or a compile checked for the cache) is not walked again
+    int max_stack_depth = ir_code->verified_depth;
+    VMResult verify_result = max_stack_depth >= 0 ? VM_SUCCESS : verify_ir_code(ir_code, &max_stack_depth, 1);
+    if(verify_result != VM_SUCCESS){
+        spade_printf("Error: IR code failed verification\n");
+        vm->machine_state = ERROR;
+        return verify_result;
+    }
+
+    if(vm->stack_count + 1 + max_stack_depth > vm->stack_capacity){
+        int new_capacity = vm->stack_count + 1 + max_stack_depth;
+        int *new_stack = realloc(vm->stack, sizeof(int) * new_capacity);
+        if(!new_stack){
+            spade_printf("Error: Failed to allocate stack of depth %d\n", new_capacity);
+            vm->machine_state = ERROR;
+            return VM_OUT_OF_MEMORY;
+        }
+        vm->stack = new_stack;
+        vm->stack_capacity = new_capacity;
+    }
+
+    if(reserve_variables(vm, ir_code->slot_count) != VM_SUCCESS){
+        spade_printf("Error: Failed to allocate %d variable slots\n", ir_code->slot_count);
+        vm->machine_state = ERROR;
+        return VM_OUT_OF_MEMORY;
+    }
+    vm->variable_names = ir_code->slot_names;
+    vm->slot_is_string = ir_code->slot_is_string;
+
+    if(load_string_literals(vm, ir_code->strings) != VM_SUCCESS){
+        vm->machine_state = ERROR;
+        return VM_OUT_OF_MEMORY;
+    }
+
+    const unsigned char *bytecode = ir_code->bytecode;
+    const unsigned char *pc = bytecode;
+    int *sp = vm->stack + vm->stack_count + 1;
+    int *variables = vm->variables;
+    int *literals = vm->literal_indices;
+
+#if SPADE_COMPUTED_GOTO
+    // Must list a label for every IROpcode, in enum order
+    static void *dispatch_table[] = {
+        &&label_IR_PUSH_CONST, &&label_IR_PUSH_VAR, &&label_IR_PUSH_STRING_LIT, &&label_IR_STORE_VAR,
+        &&label_IR_CONCAT, &&label_IR_ADD, &&label_IR_SUB, &&label_IR_MUL, &&label_IR_DIV,
+        &&label_IR_MOD, &&label_IR_POW, &&label_IR_EQ, &&label_IR_NE, &&label_IR_LT,
+        &&label_IR_GT, &&label_IR_LE, &&label_IR_GE, &&label_IR_AND, &&label_IR_OR,
+        &&label_IR_NOT, &&label_IR_NEG, &&label_IR_STR_EQ, &&label_IR_STR_NE, &&label_IR_ADD_VAR_CONST, &&label_IR_INC_VAR,
+        &&label_IR_EQ_VAR_VAR, &&label_IR_NE_VAR_VAR, &&label_IR_LT_VAR_VAR, &&label_IR_LE_VAR_VAR,
+        &&label_IR_JUMP, &&label_IR_JUMP_IF_FALSE, &&label_IR_JUMP_IF_TRUE,
+        &&label_IR_HALT
+    };
+
+    VM_DISPATCH();
+    {
+#else
+    for(;;){
+        switch (*pc++) {
+#endif
+            VM_CASE(IR_PUSH_CONST) {
                 int value;
-                if(pop_stack(vm, &value) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(store_variable(vm, instr->operand.var_name, value) != VM_SUCCESS){
-                    printf("Error: Failed to store variable %s MACHINE OUT OF MEMORY\n", instr->operand.var_name);
-                    vm->machine_state = ERROR;
-                    return VM_OUT_OF_MEMORY;
-                }
-                break;
+                VM_READ_INT(value);
+                VM_PUSH(value);
+                VM_NEXT();
             }
                 
-            case IR_CONCAT: {
-                // String concatenation
-                int right_idx, left_idx;
-                if(pop_stack(vm, &right_idx) != VM_SUCCESS || pop_stack(vm, &left_idx) != VM_SUCCESS){
-                    printf("Error: Stack Underflow during string concatenation\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                
-                // Get the strings from the string pool
-                char *left_str, *right_str;
-                if(load_string(vm, left_idx, &left_str) != VM_SUCCESS || 
-                   load_string(vm, right_idx, &right_str) != VM_SUCCESS){
-                    printf("Error: Failed to load strings for concatenation\n");
-                    vm->machine_state = ERROR;
-                    return VM_INDEX_OUT_OF_BOUNDS;
-                }
-                
-                // Calculate new string length and allocate memory
-                int new_len = strlen(left_str) + strlen(right_str) + 1;
-                char *result = malloc(new_len);
-                if (!result) {
-                    printf("Error: Failed to allocate memory for string concatenation\n");
-                    vm->machine_state = ERROR;
-                    return VM_OUT_OF_MEMORY;
-                }
-                
-                // Concatenate the strings
-                strcpy(result, left_str);
-                strcat(result, right_str);
+            VM_CASE(IR_PUSH_STRING_LIT) {
+                int literal;
+                VM_READ_SLOT(literal);
+                VM_PUSH(literals[literal]);
+                VM_NEXT();
+            }
                 
-                // Store the result in the string pool and push its index
-                if(store_string(vm, result) != VM_SUCCESS){
-                    printf("Error: Failed to store concatenated string\n");
-                    free(result);
-                    vm->machine_state = ERROR;
-                    return VM_OUT_OF_MEMORY;
-                }
+            VM_CASE(IR_PUSH_VAR) {
+                int slot;
+                VM_READ_SLOT(slot);
+                VM_PUSH(variables[slot]);
+                VM_NEXT();
+            }
                 
-                // Free the temporary result string (it's been copied by store_string)
-                free(result);
-                break;
+            VM_CASE(IR_STORE_VAR) {
+                int slot;
+                VM_READ_SLOT(slot);
+                variables[slot] = VM_POP();
+                VM_NEXT();
             }
                 
-            case IR_ADD: {
-                // TODO: Implement addition
-                int left, right;
-
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
+            VM_CASE(IR_CONCAT) {
+                int right_idx = VM_POP();
+                int left_idx = VM_TOP();
+                VM_SYNC();  // The string collector scans the stack
+                VMResult concat_result = concat_strings(vm, left_idx, right_idx, &VM_TOP());
+                if(concat_result != VM_SUCCESS){
+                    VM_ERROR(concat_result);
                 }
+                VM_NEXT();
+            }
                 
-                if(push_stack(vm, left + right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_ADD) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() + right;
+                VM_NEXT();
             }
                 
-            case IR_SUB: {
-                // TODO: Implement subtraction
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-
-                if(push_stack(vm, left - right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_SUB) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() - right;
+                VM_NEXT();
             }
                 
-            case IR_MUL: {
-                // TODO: Implement multiplication
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-
-                if(push_stack(vm, left * right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_MUL) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() * right;
+                VM_NEXT();
             }
                 
-            case IR_DIV: {
-                // TODO: Implement division
-                int left, right;
-
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-
+            VM_CASE(IR_DIV) {
+                int right = VM_POP();
                 if(right == 0){
-                    printf("Error: Division by zero\n");
-                    vm->machine_state = ERROR;
-                    return VM_INVALID_INSTRUCTION;
-                }
-
-                if(push_stack(vm, left / right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
+                    spade_printf("Error: Division by zero\n");
+                    VM_ERROR(VM_INVALID_INSTRUCTION);
                 }
-
-                break;
+                VM_TOP() = VM_TOP() / right;
+                VM_NEXT();
             }
                 
-            case IR_MOD: {
-                // TODO: Implement modulo
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
+            VM_CASE(IR_MOD) {
+                int right = VM_POP();
                 if(right == 0){
-                    printf("Error: Modulo by zero\n");
-                    vm->machine_state = ERROR;
-                    return VM_INVALID_INSTRUCTION;
-                }
-                if(push_stack(vm, left % right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
+                    spade_printf("Error: Modulo by zero\n");
+                    VM_ERROR(VM_INVALID_INSTRUCTION);
                 }
-                break;
+                VM_TOP() = VM_TOP() % right;
+                VM_NEXT();
             }
                 
-            case IR_POW: {
-                // Implement safe power with overflow detection
-                int base, exponent;
-                if(pop_stack(vm, &exponent) != VM_SUCCESS || pop_stack(vm, &base) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
+            VM_CASE(IR_POW) {
+                // Safe power with overflow detection
+                int exponent = VM_POP();
+                int base = VM_TOP();
                 
                 int power_result;
-                VMResult safe_result = safe_int_power(base, exponent, &power_result);
+                VMResult safe_result = safe_int_power(base, exponent, &power_result, 1);
                 if (safe_result != VM_SUCCESS) {
-                    printf("Error: Power operation failed (base=%d, exp=%d)\n", base, exponent);
-                    vm->machine_state = ERROR;
-                    return safe_result;
+                    spade_printf("Error: Power operation failed (base=%d, exp=%d)\n", base, exponent);
+                    VM_ERROR(safe_result);
                 }
+                VM_TOP() = power_result;
+                VM_NEXT();
+            }
                 
-                if(push_stack(vm, power_result) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_EQ) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() == right;
+                VM_NEXT();
             }
                 
-            case IR_EQ: {
-                // TODO: Implement equal comparison
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, left == right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_NE) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() != right;
+                VM_NEXT();
             }
                 
-            case IR_NE: {
-                // TODO: Implement not equal comparison
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, left != right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_LT) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() < right;
+                VM_NEXT();
             }
                 
-            case IR_LT: {
-                // TODO: Implement less than comparison
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, left < right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_GT) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() > right;
+                VM_NEXT();
             }
                 
-            case IR_GT: {
-                // TODO: Implement greater than comparison
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, left > right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_LE) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() <= right;
+                VM_NEXT();
             }
                 
-            case IR_LE: {
-                // TODO: Implement less equal comparison
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, left <= right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_GE) {
+                int right = VM_POP();
+                VM_TOP() = VM_TOP() >= right;
+                VM_NEXT();
             }
                 
-            case IR_GE: {
-                // TODO: Implement greater equal comparison
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, left >= right) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_AND) {
+                int right = VM_POP();
+                VM_TOP() = (VM_TOP() && right) ? 1 : 0;
+                VM_NEXT();
             }
                 
-            case IR_AND: {
-                // TODO: Implement logical and
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, (left && right) ? 1 : 0) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
-                }
-                break;
+            VM_CASE(IR_OR) {
+                int right = VM_POP();
+                VM_TOP() = (VM_TOP() || right) ? 1 : 0;
+                VM_NEXT();
             }
                 
-            case IR_OR: {
-                // TODO: Implement logical or
-                int left, right;
-                if(pop_stack(vm, &right) != VM_SUCCESS || pop_stack(vm, &left) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
-                }
-                if(push_stack(vm, (left || right) ? 1 : 0) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
+            VM_CASE(IR_NOT)
+                VM_TOP() = !VM_TOP() ? 1 : 0;
+                VM_NEXT();
+                
+            VM_CASE(IR_NEG)
+                VM_TOP() = -VM_TOP();
+                VM_NEXT();
+
+            VM_CASE(IR_STR_EQ)
+            VM_CASE(IR_STR_NE) {
+                int right = VM_POP();
+                int equal;
+                VMResult compare_result = compare_strings(vm, VM_TOP(), right, &equal);
+                if(compare_result != VM_SUCCESS){
+                    VM_ERROR(compare_result);
                 }
-                break;
+                VM_TOP() = pc[-1] == IR_STR_EQ ? equal : !equal;  // Neither has operands
+                VM_NEXT();
+            }
+
+            // Superinstructions: one dispatch for PUSH_VAR/PUSH_CONST/ADD(/STORE_VAR)
+            // and PUSH_VAR/PUSH_VAR/<compare>
+            VM_CASE(IR_ADD_VAR_CONST) {
+                int slot, value;
+                VM_READ_SLOT(slot);
+                VM_READ_INT(value);
+                VM_PUSH(variables[slot] + value);
+                VM_NEXT();
+            }
+
+            VM_CASE(IR_INC_VAR) {
+                int slot, value;
+                VM_READ_SLOT(slot);
+                VM_READ_INT(value);
+                variables[slot] += value;
+                VM_NEXT();
+            }
+
+            VM_CASE(IR_EQ_VAR_VAR) {
+                int left, right;
+                VM_READ_SLOT(left);
+                VM_READ_SLOT(right);
+                VM_PUSH(variables[left] == variables[right]);
+                VM_NEXT();
+            }
+
+            VM_CASE(IR_NE_VAR_VAR) {
+                int left, right;
+                VM_READ_SLOT(left);
+                VM_READ_SLOT(right);
+                VM_PUSH(variables[left] != variables[right]);
+                VM_NEXT();
+            }
+
+            VM_CASE(IR_LT_VAR_VAR) {
+                int left, right;
+                VM_READ_SLOT(left);
+                VM_READ_SLOT(right);
+                VM_PUSH(variables[left] < variables[right]);
+                VM_NEXT();
+            }
+
+            VM_CASE(IR_LE_VAR_VAR) {
+                int left, right;
+                VM_READ_SLOT(left);
+                VM_READ_SLOT(right);
+                VM_PUSH(variables[left] <= variables[right]);
+                VM_NEXT();
+            }
+
+            // Targets are verified byte offsets of an opcode, so a taken branch just moves pc
+            VM_CASE(IR_JUMP) {
+                int target;
+                VM_READ_TARGET(target);
+                pc = bytecode + target;
+                VM_NEXT();
+            }
+
+            VM_CASE(IR_JUMP_IF_FALSE) {
+                int target;
+                VM_READ_TARGET(target);
+                if(!VM_POP()) pc = bytecode + target;
+                VM_NEXT();
+            }
+
+            VM_CASE(IR_JUMP_IF_TRUE) {
+                int target;
+                VM_READ_TARGET(target);
+                if(VM_POP()) pc = bytecode + target;
+                VM_NEXT();
             }
                 
-            case IR_NOT: {
-                // TODO: Implement logical not
-                int value;
-                if(pop_stack(vm, &value) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
+            VM_CASE(IR_HALT)
+                VM_SYNC();
+                if(flatten_string_slots(vm) != VM_SUCCESS){
+                    VM_ERROR(VM_OUT_OF_MEMORY);
                 }
-                if(push_stack(vm, !value ? 1 : 0) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
+                vm->machine_state = HALTED;
+                return VM_SUCCESS;
+
+#if !SPADE_COMPUTED_GOTO
+            default:
+                VM_ERROR(VM_INVALID_INSTRUCTION);
+        }
+#endif
+    }
+}
+
+#undef VM_READ_SLOT
+#undef VM_READ_INT
+#undef VM_READ_TARGET
+#undef VM_PUSH
+#undef VM_POP
+#undef VM_TOP
+#undef VM_SYNC
+#undef VM_ERROR
+
+// The register tier dispatches on an array of fixed-size instructions
+#undef VM_NEXT
+#if SPADE_COMPUTED_GOTO
+#undef VM_DISPATCH
+#define VM_DISPATCH() goto *dispatch_table[instr->opcode]
+#define VM_NEXT() do { instr++; VM_DISPATCH(); } while (0)
+#define VM_BRANCH() VM_DISPATCH()
+#else
+#define VM_NEXT() instr++; continue
+#define VM_BRANCH() continue
+#endif
+
+#define REG_ERROR(result) do { \
+        vm->program_counter = (int)(instr - code->instructions); \
+        vm->machine_state = ERROR; \
+        return (result); \
+    } while (0)
+
+/**
+ * Executes register code on the virtual machine
+ * 
+ * The register file is the VM's variable array: the first slot_count entries
+ * are the program's variables (so print_VM_state shows them as usual),
+ * followed by the temporaries and the preloaded constant registers. Each
+ * instruction reads its operands and writes its result in place, without
+ * touching the VM stack.
+ * 
+ * @param vm Pointer to the virtual machine
+ * @param code Pointer to the register code to execute (from lower_ir_to_reg)
+ * @return VM_SUCCESS or appropriate error code
+ */
+VMResult execute_reg_code(VirtualMachine *vm, RegCode *code){
+    vm->program_counter = 0;
+    vm->machine_state = RUNNING;
+
+    int constant_base = code->slot_count + code->temp_count;
+    if(reserve_variables(vm, constant_base + code->constant_count) != VM_SUCCESS){
+        spade_printf("Error: Failed to allocate %d registers\n", constant_base + code->constant_count);
+        vm->machine_state = ERROR;
+        return VM_OUT_OF_MEMORY;
+    }
+    vm->variable_count = code->slot_count;
+    vm->variable_names = code->slot_names;
+    vm->slot_is_string = code->slot_is_string;
+
+    if(load_string_literals(vm, code->strings) != VM_SUCCESS){
+        vm->machine_state = ERROR;
+        return VM_OUT_OF_MEMORY;
+    }
+
+    int *r = vm->variables;
+    int *literals = vm->literal_indices;
+    for(int i = 0; i < code->constant_count; i++){
+        r[constant_base + i] = code->constants[i];
+    }
+
+    RegInstruction *instr = code->instructions;
+
+#if SPADE_COMPUTED_GOTO
+    // Must list a label for every RegOpcode, in enum order
+    static void *dispatch_table[] = {
+        &&label_REG_MOVE, &&label_REG_LOAD_STRING, &&label_REG_CONCAT, &&label_REG_ADD,
+        &&label_REG_SUB, &&label_REG_MUL, &&label_REG_DIV, &&label_REG_MOD, &&label_REG_POW,
+        &&label_REG_EQ, &&label_REG_NE, &&label_REG_LT, &&label_REG_GT, &&label_REG_LE,
+        &&label_REG_GE, &&label_REG_AND, &&label_REG_OR, &&label_REG_NOT, &&label_REG_NEG,
+        &&label_REG_STR_EQ, &&label_REG_STR_NE, &&label_REG_JUMP, &&label_REG_JUMP_IF_FALSE,
+        &&label_REG_JUMP_IF_TRUE, &&label_REG_HALT
+    };
+
+    VM_DISPATCH();
+    {
+#else
+    for(;;){
+        switch (instr->opcode) {
+#endif
+            VM_CASE(REG_MOVE)
+                r[instr->dst] = r[instr->a];
+                VM_NEXT();
+
+            VM_CASE(REG_LOAD_STRING)
+                r[instr->dst] = literals[instr->a];
+                VM_NEXT();
+
+            VM_CASE(REG_CONCAT) {
+                int index;
+                VMResult concat_result = concat_strings(vm, r[instr->a], r[instr->b], &index);
+                if(concat_result != VM_SUCCESS){
+                    REG_ERROR(concat_result);
                 }
-                break;
+                r[instr->dst] = index;
+                VM_NEXT();
             }
-                
-            case IR_NEG: {
-                // TODO: Implement negation
-                int value;
-                if(pop_stack(vm, &value) != VM_SUCCESS){
-                    printf("Error: Stack Underflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_UNDERFLOW;
+
+            VM_CASE(REG_ADD)
+                r[instr->dst] = r[instr->a] + r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_SUB)
+                r[instr->dst] = r[instr->a] - r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_MUL)
+                r[instr->dst] = r[instr->a] * r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_DIV)
+                if(r[instr->b] == 0){
+                    spade_printf("Error: Division by zero\n");
+                    REG_ERROR(VM_INVALID_INSTRUCTION);
                 }
-                if(push_stack(vm, -value) != VM_SUCCESS){
-                    printf("Error: Stack Overflow\n");
-                    vm->machine_state = ERROR;
-                    return VM_STACK_OVERFLOW;
+                r[instr->dst] = r[instr->a] / r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_MOD)
+                if(r[instr->b] == 0){
+                    spade_printf("Error: Modulo by zero\n");
+                    REG_ERROR(VM_INVALID_INSTRUCTION);
                 }
-                break;
+                r[instr->dst] = r[instr->a] % r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_POW) {
+                int power_result;
+                VMResult safe_result = safe_int_power(r[instr->a], r[instr->b], &power_result, 1);
+                if (safe_result != VM_SUCCESS) {
+                    spade_printf("Error: Power operation failed (base=%d, exp=%d)\n", r[instr->a], r[instr->b]);
+                    REG_ERROR(safe_result);
+                }
+                r[instr->dst] = power_result;
+                VM_NEXT();
             }
-                
-            case IR_HALT:
+
+            VM_CASE(REG_EQ)
+                r[instr->dst] = r[instr->a] == r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_NE)
+                r[instr->dst] = r[instr->a] != r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_LT)
+                r[instr->dst] = r[instr->a] < r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_GT)
+                r[instr->dst] = r[instr->a] > r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_LE)
+                r[instr->dst] = r[instr->a] <= r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_GE)
+                r[instr->dst] = r[instr->a] >= r[instr->b];
+                VM_NEXT();
+
+            VM_CASE(REG_AND)
+                r[instr->dst] = (r[instr->a] && r[instr->b]) ? 1 : 0;
+                VM_NEXT();
+
+            VM_CASE(REG_OR)
+                r[instr->dst] = (r[instr->a] || r[instr->b]) ? 1 : 0;
+                VM_NEXT();
+
+            VM_CASE(REG_NOT)
+                r[instr->dst] = !r[instr->a] ? 1 : 0;
+                VM_NEXT();
+
+            VM_CASE(REG_NEG)
+                r[instr->dst] = -r[instr->a];
+                VM_NEXT();
+
+            VM_CASE(REG_STR_EQ)
+            VM_CASE(REG_STR_NE) {
+                int equal;
+                VMResult compare_result = compare_strings(vm, r[instr->a], r[instr->b], &equal);
+                if(compare_result != VM_SUCCESS){
+                    REG_ERROR(compare_result);
+                }
+                r[instr->dst] = instr->opcode == REG_STR_EQ ? equal : !equal;
+                VM_NEXT();
+            }
+
+            // dst is the target's index, resolved by lower_ir_to_reg
+            VM_CASE(REG_JUMP)
+                instr = code->instructions + instr->dst;
+                VM_BRANCH();
+
+            VM_CASE(REG_JUMP_IF_FALSE)
+                if(!r[instr->a]){
+                    instr = code->instructions + instr->dst;
+                    VM_BRANCH();
+                }
+                VM_NEXT();
+
+            VM_CASE(REG_JUMP_IF_TRUE)
+                if(r[instr->a]){
+                    instr = code->instructions + instr->dst;
+                    VM_BRANCH();
+                }
+                VM_NEXT();
+
+            VM_CASE(REG_HALT)
+                if(flatten_string_slots(vm) != VM_SUCCESS){
+                    REG_ERROR(VM_OUT_OF_MEMORY);
+                }
+                vm->program_counter = (int)(instr - code->instructions);
                 vm->machine_state = HALTED;
-                break;
-                
+                return VM_SUCCESS;
+
+#if !SPADE_COMPUTED_GOTO
             default:
-                vm->machine_state = ERROR;
-                return VM_INVALID_INSTRUCTION;
+                REG_ERROR(VM_INVALID_INSTRUCTION);
         }
-        
-        vm->program_counter++;
+#endif
     }
-    
-    return VM_SUCCESS;
-}
\ No newline at end of file
+}
+
+#undef REG_ERROR
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef VM_NEXT
+#undef VM_BRANCH
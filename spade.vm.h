@@ -20,10 +20,27 @@ typedef enum {
     VM_INVALID_INSTRUCTION,
 } VMResult;
 
+// Minimum number of strings created between two string pool collections
+#define STRING_GC_MIN_THRESHOLD 64
+
+// Concatenations at least this long are kept as rope nodes instead of being copied
+#define ROPE_MIN_LENGTH 64
+
+// String values are pool indices (>= 0) or rope nodes (< 0)
+#define ROPE_VALUE(node) (-(node) - 1)
+#define ROPE_NODE(value) (-(value) - 1)
+
+/**
+ * Lazy concatenation: a rope node stands for left + right without copying
+ * either part. It is flattened into the string pool only when contiguous
+ * text is needed.
+ */
 typedef struct {
-    char *name;
-    int value;
-}Variable;
+    int left;       // String value of the left part (next free node while on the free list)
+    int right;      // String value of the right part
+    int length;     // Total length in bytes, -1 while the node is on the free list
+    int flat;       // Pool index of the flattened text, -1 until flattened
+} RopeNode;
 
 typedef struct {
 
@@ -31,11 +48,21 @@ typedef struct {
     int stack_count;
     int stack_capacity;
 
-    char **string_pool;
-    int string_pool_count;
-    int string_pool_capacity;
+    StringTable *string_pool;   // Interned runtime strings, so equal strings share one index
+    int *literal_indices;       // Pool index of each string literal of the running code
+    int literal_count;
+
+    RopeNode *ropes;            // Rope nodes created by long concatenations
+    int rope_count;
+    int rope_capacity;
+    int rope_free;              // First node on the free list, -1 if empty
 
-    Variable *variables;
+    int strings_since_gc;       // Strings added to the pool since the last collection
+    int gc_threshold;           // Collect the pool once this many strings were added
+
+    int *variables;             // Variable slots, indexed by the slot numbers assigned during IR generation
+    char **variable_names;      // Slot names borrowed from the IR code (for debugging output)
+    unsigned char *slot_is_string; // Borrowed from the IR code, marks the slots that hold strings
     int variable_count;
     int variable_capacity;
 
@@ -45,6 +72,7 @@ typedef struct {
 }VirtualMachine;
 
 VirtualMachine createVirtualMachine();
+VMResult safe_int_power(int base, int exponent, int *result, int report_errors);
 void print_VM_state(VirtualMachine *vm);
 void free_VM(VirtualMachine *vm);
 
@@ -52,19 +80,23 @@ VMResult push_stack(VirtualMachine *vm, int value);
 VMResult pop_stack(VirtualMachine *vm, int *value);
 void peek_stack(VirtualMachine *vm);
 
-VMResult store_variable(VirtualMachine *vm, char *name, int value);
-VMResult load_variable(VirtualMachine *vm, char *name);
+VMResult reserve_variables(VirtualMachine *vm, int slot_count);
+VMResult store_variable(VirtualMachine *vm, int slot, int value);
+VMResult load_variable(VirtualMachine *vm, int slot);
 void peek_variables(VirtualMachine *vm);
 
-VMResult store_string(VirtualMachine *vm, char *string);
-VMResult load_string(VirtualMachine *vm, int index, char **string);
+VMResult store_string(VirtualMachine *vm, const char *string, int length, int *index);
+VMResult load_string(VirtualMachine *vm, int index, const char **string);
+VMResult load_string_literals(VirtualMachine *vm, StringTable *literals);
+int collect_strings(VirtualMachine *vm, const int *extra_roots, int extra_count);
+VMResult concat_strings(VirtualMachine *vm, int left_idx, int right_idx, int *index);
+VMResult flatten_string(VirtualMachine *vm, int value, int *index);
+VMResult compare_strings(VirtualMachine *vm, int left, int right, int *equal);
+VMResult flatten_string_slots(VirtualMachine *vm);
 void peek_string_pool(VirtualMachine *vm);
 
-// internal functions
-Variable *lookup_variable(VirtualMachine *vm, char *name);
-int update_variable(VirtualMachine *vm, char *name, int value);
-
-
+VMResult verify_ir_code(IRCode *ir_code, int *max_stack_depth, int report_errors);
 VMResult execute_ir_code(VirtualMachine *vm, IRCode *ir_code);
+VMResult execute_reg_code(VirtualMachine *vm, RegCode *code);
 
 #endif
\ No newline at end of file